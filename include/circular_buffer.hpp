@@ -19,7 +19,22 @@
 
 
 #include <circular_buffer/config.hpp>
+#include <circular_buffer/overflow.hpp>
 #include <circular_buffer/static_circular_buffer.hpp>
 #include <circular_buffer/dynamic_circular_buffer.hpp>
+#include <circular_buffer/window_aggregator.hpp>
+#include <circular_buffer/range_sum_index.hpp>
+#include <circular_buffer/order_statistics_window.hpp>
+#include <circular_buffer/fir_filter.hpp>
+#include <circular_buffer/delay_line.hpp>
+#include <circular_buffer/time_window_buffer.hpp>
+#include <circular_buffer/cascading_buffer.hpp>
+#include <circular_buffer/compressed_series.hpp>
+#include <circular_buffer/byte_record_ring.hpp>
+#include <circular_buffer/command_ring.hpp>
+#include <circular_buffer/snapshot.hpp>
+#include <circular_buffer/spilling_circular_buffer.hpp>
+#include <circular_buffer/coroutine_channel.hpp>
+#include <circular_buffer/stats_registry.hpp>
 
 #endif // include guard
@@ -0,0 +1,492 @@
+#ifndef JM_ASYNC_DRAIN_HPP
+#define JM_ASYNC_DRAIN_HPP
+
+// Linux only, not included by circular_buffer.hpp
+
+#include <circular_buffer/config.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace jm {
+  namespace detail {
+    // pwritev request shared by the drain and its backend
+    struct drain_request {
+      iovec iov[2];
+      int   iovcnt;
+      off_t offset;
+      bool  done;
+    };
+
+    // Minimal io_uring submission / completion queue set up with raw syscalls.
+    class uring_backend {
+      int           _fd;
+      void*         _sq_ptr;
+      std::size_t   _sq_len;
+      void*         _cq_ptr;
+      std::size_t   _cq_len;
+      io_uring_sqe* _sqes;
+      std::size_t   _sqes_len;
+      unsigned*     _sq_tail;
+      unsigned*     _sq_mask;
+      unsigned*     _sq_array;
+      unsigned*     _cq_head;
+      unsigned*     _cq_tail;
+      unsigned*     _cq_mask;
+      io_uring_cqe* _cqes;
+
+      static unsigned load_acquire(const unsigned* p) JM_CB_NOEXCEPT { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+
+      static void store_release(unsigned* p, unsigned v) JM_CB_NOEXCEPT { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+
+      template<class T>
+      static T* at(void* base, unsigned offset) JM_CB_NOEXCEPT
+      {
+        return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+      }
+
+      int enter(unsigned to_submit, unsigned min_complete, unsigned flags) JM_CB_NOEXCEPT
+      {
+        int r;
+        do
+          r = static_cast<int>(::syscall(__NR_io_uring_enter, _fd, to_submit, min_complete, flags, JM_CB_NULLPTR, 0));
+        while (r < 0 && errno == EINTR);
+        return r;
+      }
+
+    public:
+      uring_backend() JM_CB_NOEXCEPT
+        : _fd(-1), _sq_ptr(MAP_FAILED), _sq_len(0), _cq_ptr(MAP_FAILED), _cq_len(0),
+          _sqes(JM_CB_NULLPTR), _sqes_len(0), _sq_tail(JM_CB_NULLPTR), _sq_mask(JM_CB_NULLPTR),
+          _sq_array(JM_CB_NULLPTR), _cq_head(JM_CB_NULLPTR), _cq_tail(JM_CB_NULLPTR),
+          _cq_mask(JM_CB_NULLPTR), _cqes(JM_CB_NULLPTR)
+      {}
+
+      uring_backend(const uring_backend&) = delete;
+      uring_backend& operator=(const uring_backend&) = delete;
+
+      ~uring_backend() { close(); }
+
+      bool is_open() const JM_CB_NOEXCEPT { return _fd >= 0; }
+
+      // false if the kernel ( or a seccomp filter ) does not allow io_uring
+      bool open(unsigned entries) JM_CB_NOEXCEPT
+      {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        _fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (_fd < 0)
+          return false;
+
+        _sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        _cq_len = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap)
+          _sq_len = _cq_len = std::max(_sq_len, _cq_len);
+
+        _sq_ptr = ::mmap(JM_CB_NULLPTR, _sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd,
+                         IORING_OFF_SQ_RING);
+        if (_sq_ptr == MAP_FAILED) {
+          close();
+          return false;
+        }
+
+        if (single_mmap)
+          _cq_ptr = _sq_ptr;
+        else {
+          _cq_ptr = ::mmap(JM_CB_NULLPTR, _cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd,
+                           IORING_OFF_CQ_RING);
+          if (_cq_ptr == MAP_FAILED) {
+            close();
+            return false;
+          }
+        }
+
+        _sqes_len = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(JM_CB_NULLPTR, _sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd,
+                            IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+          close();
+          return false;
+        }
+        _sqes = static_cast<io_uring_sqe*>(sqes);
+
+        _sq_tail = at<unsigned>(_sq_ptr, params.sq_off.tail);
+        _sq_mask = at<unsigned>(_sq_ptr, params.sq_off.ring_mask);
+        _sq_array = at<unsigned>(_sq_ptr, params.sq_off.array);
+        _cq_head = at<unsigned>(_cq_ptr, params.cq_off.head);
+        _cq_tail = at<unsigned>(_cq_ptr, params.cq_off.tail);
+        _cq_mask = at<unsigned>(_cq_ptr, params.cq_off.ring_mask);
+        _cqes = at<io_uring_cqe>(_cq_ptr, params.cq_off.cqes);
+        return true;
+      }
+
+      void close() JM_CB_NOEXCEPT
+      {
+        if (_sqes != JM_CB_NULLPTR)
+          ::munmap(_sqes, _sqes_len);
+        if (_cq_ptr != MAP_FAILED && _cq_ptr != _sq_ptr)
+          ::munmap(_cq_ptr, _cq_len);
+        if (_sq_ptr != MAP_FAILED)
+          ::munmap(_sq_ptr, _sq_len);
+        if (_fd >= 0)
+          ::close(_fd);
+
+        _fd = -1;
+        _sqes = JM_CB_NULLPTR;
+        _sq_ptr = _cq_ptr = MAP_FAILED;
+      }
+
+      // queues a writev, the request must stay alive until it completes
+      void submit(int fd, drain_request& request, std::uint64_t id)
+      {
+        const unsigned tail = *_sq_tail;
+        const unsigned index = tail & *_sq_mask;
+
+        io_uring_sqe& sqe = _sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_WRITEV;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(request.iov);
+        sqe.len = static_cast<unsigned>(request.iovcnt);
+        sqe.off = static_cast<std::uint64_t>(request.offset);
+        sqe.user_data = id;
+        _sq_array[index] = index;
+        store_release(_sq_tail, tail + 1);
+
+        if (enter(1, 0, 0) < 0)
+          throw std::system_error(errno, std::generic_category(), "io_uring_enter failed");
+      }
+
+      // calls f(id, result) for every completion, waiting for one if wait is set
+      template<class F>
+      void reap(F f, bool wait)
+      {
+        if (wait && load_acquire(_cq_tail) == *_cq_head && enter(0, 1, IORING_ENTER_GETEVENTS) < 0)
+          throw std::system_error(errno, std::generic_category(), "io_uring_enter failed");
+
+        // every entry is released before f runs, so a throwing f does not see it again
+        const unsigned tail = load_acquire(_cq_tail);
+        for (unsigned head = *_cq_head; head != tail;) {
+          const io_uring_cqe cqe = _cqes[head & *_cq_mask];
+          store_release(_cq_head, ++head);
+          f(cqe.user_data, static_cast<ssize_t>(cqe.res));
+        }
+      }
+    };
+
+    // Fallback for kernels without io_uring: a worker thread issuing pwritev.
+    class thread_backend {
+      std::mutex                                           _mutex;
+      std::condition_variable                              _work;
+      std::condition_variable                              _completed;
+      std::deque<std::pair<drain_request*, std::uint64_t>> _queue;
+      std::deque<std::pair<std::uint64_t, ssize_t>>        _results;
+      bool                                                 _stop;
+      int                                                  _fd;
+      std::thread                                          _worker;
+
+      void run()
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (;;) {
+          _work.wait(lock, [this] { return _stop || !_queue.empty(); });
+          if (_queue.empty())
+            return;
+
+          const auto job = _queue.front();
+          _queue.pop_front();
+          lock.unlock();
+
+          ssize_t n;
+          do
+            n = ::pwritev(_fd, job.first->iov, job.first->iovcnt, job.first->offset);
+          while (n < 0 && errno == EINTR);
+
+          lock.lock();
+          _results.emplace_back(job.second, n < 0 ? -errno : n);
+          _completed.notify_one();
+        }
+      }
+
+    public:
+      thread_backend() : _stop(false), _fd(-1) {}
+
+      thread_backend(const thread_backend&) = delete;
+      thread_backend& operator=(const thread_backend&) = delete;
+
+      ~thread_backend()
+      {
+        if (!_worker.joinable())
+          return;
+
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          _stop = true;
+        }
+        _work.notify_one();
+        _worker.join();
+      }
+
+      void start(int fd)
+      {
+        _fd = fd;
+        _worker = std::thread(&thread_backend::run, this);
+      }
+
+      void submit(int, drain_request& request, std::uint64_t id)
+      {
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          _queue.emplace_back(&request, id);
+        }
+        _work.notify_one();
+      }
+
+      template<class F>
+      void reap(F f, bool wait)
+      {
+        std::deque<std::pair<std::uint64_t, ssize_t>> results;
+        {
+          std::unique_lock<std::mutex> lock(_mutex);
+          if (wait)
+            _completed.wait(lock, [this] { return !_results.empty(); });
+          results.swap(_results);
+        }
+
+        for (const auto& r : results)
+          f(r.first, r.second);
+      }
+    };
+  } // namespace detail
+
+  // Drains a ring of trivially copyable elements to a file descriptor in the
+  // background. The used segments are submitted as writev requests to io_uring when
+  // the kernel allows it, or to a pwritev worker thread otherwise, with at most
+  // max_in_flight requests pending. Elements are popped from the ring only after the
+  // write covering them completed, so the producer must not overwrite: it checks
+  // full() and calls wait() ( the stall ) before pushing into a full ring.
+  //
+  // All member functions are called from the thread that pushes into the ring.
+  template<class Buffer>
+  class async_drain {
+  public:
+    typedef typename Buffer::value_type value_type;
+    typedef typename Buffer::size_type  size_type;
+
+    enum class backend { automatic, io_uring, thread };
+
+  private:
+    static_assert(std::is_trivially_copyable<value_type>::value, "elements are written to disk as bytes");
+
+    Buffer&                            _ring;
+    int                                _fd;
+    off_t                              _offset; // file offset of the next submission
+    size_type                          _submitted; // elements after front() covered by requests
+    size_type                          _write_size;
+    std::vector<detail::drain_request> _requests; // fifo of in flight requests
+    size_type                          _first;
+    size_type                          _in_flight;
+    std::uint64_t                      _bytes_written;
+    detail::uring_backend              _uring;
+    detail::thread_backend             _thread;
+
+    // completes a short write synchronously, it is rare on files
+    void finish_short_write(detail::drain_request& request, ssize_t written)
+    {
+      std::size_t done = static_cast<std::size_t>(written);
+      for (int i = 0; i < request.iovcnt; ++i) {
+        const std::size_t skip = std::min(done, request.iov[i].iov_len);
+        done -= skip;
+
+        const char* data = static_cast<const char*>(request.iov[i].iov_base) + skip;
+        std::size_t left = request.iov[i].iov_len - skip;
+        off_t       offset = request.offset + written;
+        while (left != 0) {
+          const ssize_t n = ::pwrite(_fd, data, left, offset);
+          if (n < 0 && errno == EINTR)
+            continue;
+          if (n <= 0)
+            throw std::system_error(n < 0 ? errno : EIO, std::generic_category(), "async_drain write failed");
+          data += n;
+          left -= static_cast<std::size_t>(n);
+          offset += n;
+          written += n;
+        }
+      }
+    }
+
+    void complete(std::uint64_t id, ssize_t result)
+    {
+      detail::drain_request& request = _requests[static_cast<size_type>(id)];
+      if (result < 0)
+        throw std::system_error(static_cast<int>(-result), std::generic_category(), "async_drain write failed");
+
+      const std::size_t bytes = request.iov[0].iov_len + (request.iovcnt == 2 ? request.iov[1].iov_len : 0);
+      if (static_cast<std::size_t>(result) < bytes)
+        finish_short_write(request, result);
+      request.done = true;
+    }
+
+    // pops the elements of the completed requests at the front of the fifo
+    size_type release()
+    {
+      size_type released = 0;
+      while (_in_flight != 0 && _requests[_first].done) {
+        const detail::drain_request& request = _requests[_first];
+        const std::size_t bytes = request.iov[0].iov_len + (request.iovcnt == 2 ? request.iov[1].iov_len : 0);
+        released += bytes / sizeof(value_type);
+        _bytes_written += bytes;
+        _first = _first + 1 == _requests.size() ? 0 : _first + 1;
+        --_in_flight;
+      }
+
+      _ring.erase_begin(released);
+      _submitted -= released;
+      return released;
+    }
+
+    void reap(bool wait)
+    {
+      const auto on_completion = [this](std::uint64_t id, ssize_t result) { complete(id, result); };
+      if (_uring.is_open())
+        _uring.reap(on_completion, wait);
+      else
+        _thread.reap(on_completion, wait);
+    }
+
+    // submits the unsubmitted elements in requests of write_size, and the last
+    // partial one if all is set
+    void submit(bool all)
+    {
+      while (_in_flight != _requests.size()) {
+        const size_type pending = _ring.size() - _submitted;
+        if (pending == 0 || (!all && pending < _write_size))
+          return;
+
+        const size_type count = std::min(pending, _write_size);
+        const auto      one = _ring.array_one();
+        const auto      two = _ring.array_two();
+
+        const size_type        slot = (_first + _in_flight) % _requests.size();
+        detail::drain_request& request = _requests[slot];
+        if (_submitted < one.second) {
+          const size_type first_len = std::min(count, one.second - _submitted);
+          request.iov[0].iov_base = const_cast<value_type*>(one.first + _submitted);
+          request.iov[0].iov_len = first_len * sizeof(value_type);
+          request.iov[1].iov_base = const_cast<value_type*>(two.first);
+          request.iov[1].iov_len = (count - first_len) * sizeof(value_type);
+          request.iovcnt = count != first_len ? 2 : 1;
+        }
+        else {
+          request.iov[0].iov_base = const_cast<value_type*>(two.first + (_submitted - one.second));
+          request.iov[0].iov_len = count * sizeof(value_type);
+          request.iovcnt = 1;
+        }
+        request.offset = _offset;
+        request.done = false;
+
+        if (_uring.is_open())
+          _uring.submit(_fd, request, slot);
+        else
+          _thread.submit(_fd, request, slot);
+
+        _offset += static_cast<off_t>(count * sizeof(value_type));
+        _submitted += count;
+        ++_in_flight;
+      }
+    }
+
+  public:
+    // drains ring to fd starting at offset, in writes of write_size elements
+    async_drain(Buffer& ring, int fd, off_t offset = 0, size_type max_in_flight = 4,
+                size_type write_size = 64 << 10, backend kind = backend::automatic)
+      : _ring(ring), _fd(fd), _offset(offset), _submitted(0), _write_size(std::max<size_type>(write_size, 1)),
+        _requests(std::max<size_type>(max_in_flight, 1)), _first(0), _in_flight(0), _bytes_written(0)
+    {
+      if (kind != backend::thread && _uring.open(static_cast<unsigned>(_requests.size())))
+        return;
+      if (kind == backend::io_uring)
+        throw std::runtime_error("io_uring is not available");
+      _thread.start(fd);
+    }
+
+    async_drain(const async_drain&) = delete;
+    async_drain& operator=(const async_drain&) = delete;
+
+    // waits for the writes in flight, the rest of the ring is left as is
+    ~async_drain()
+    {
+      try {
+        while (_in_flight != 0) {
+          reap(true);
+          release();
+        }
+      }
+      catch (...) {
+      }
+    }
+
+    bool uses_io_uring() const JM_CB_NOEXCEPT { return _uring.is_open(); }
+
+    size_type in_flight() const JM_CB_NOEXCEPT { return _in_flight; }
+
+    // bytes whose write completed
+    std::uint64_t bytes_written() const JM_CB_NOEXCEPT { return _bytes_written; }
+
+    // collects completions and submits full writes without blocking, returns the
+    // number of elements popped from the ring
+    size_type poll()
+    {
+      reap(false);
+      const size_type released = release();
+      submit(false);
+      return released;
+    }
+
+    // blocks until at least one write completes, for a producer facing a full ring
+    size_type wait()
+    {
+      submit(true);
+      if (_in_flight == 0)
+        return 0;
+
+      size_type released = 0;
+      while (released == 0) {
+        reap(true);
+        released = release();
+      }
+      submit(false);
+      return released;
+    }
+
+    // writes out the whole ring
+    void flush()
+    {
+      for (;;) {
+        submit(true);
+        if (_in_flight == 0)
+          return;
+        reap(true);
+        release();
+      }
+    }
+  };
+} // namespace jm
+
+#endif // JM_ASYNC_DRAIN_HPP
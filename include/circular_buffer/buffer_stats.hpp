@@ -0,0 +1,148 @@
+#ifndef JM_BUFFER_STATS_HPP
+#define JM_BUFFER_STATS_HPP
+
+#include <circular_buffer/config.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+
+namespace jm {
+  // Default Stats policy of the buffers: every hook is an empty constexpr function and
+  // the empty base takes no space, so nothing is left of it in the generated code.
+  struct null_buffer_stats {
+    JM_CB_CXX14_CONSTEXPR void on_push(std::size_t, std::size_t, std::size_t) JM_CB_NOEXCEPT {}
+
+    JM_CB_CXX14_CONSTEXPR void on_pop(std::size_t) JM_CB_NOEXCEPT {}
+
+    JM_CB_CXX14_CONSTEXPR void on_overwrite() JM_CB_NOEXCEPT {}
+
+    JM_CB_CXX14_CONSTEXPR void on_drop() JM_CB_NOEXCEPT {}
+  };
+
+#ifdef CLOCK_MONOTONIC_COARSE
+  // steady clock with the resolution of the scheduler tick, a few times cheaper to
+  // read than std::chrono::steady_clock
+  struct coarse_steady_clock {
+    typedef std::chrono::nanoseconds                     duration;
+    typedef duration::rep                                rep;
+    typedef duration::period                             period;
+    typedef std::chrono::time_point<coarse_steady_clock> time_point;
+
+    static JM_CB_CONSTEXPR bool is_steady = true;
+
+    static time_point now() JM_CB_NOEXCEPT
+    {
+      timespec ts;
+      ::clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+      return time_point(duration(static_cast<rep>(ts.tv_sec) * 1000000000 + ts.tv_nsec));
+    }
+  };
+#endif
+
+  struct buffer_stats_values {
+    std::uint64_t pushes;
+    std::uint64_t pops;
+    std::uint64_t overwrites;
+    std::uint64_t drops; // refused by overflow::reject or overflow::throw_exception
+    std::uint64_t high_water_mark;
+    std::uint64_t full_ns; // time spent full, the current stretch included
+  };
+
+  // Stats policy counting pushes, pops, overwritten and dropped elements, the highest
+  // size reached and the time spent full. The buffer is its only writer, so counters
+  // are updated with relaxed loads and stores rather than read-modify-writes; any
+  // thread may call snapshot() at any time. Clock is read whenever the buffer becomes
+  // full or stops being full.
+  template<class Clock = std::chrono::steady_clock>
+  class basic_buffer_stats {
+  public:
+    typedef buffer_stats_values values;
+
+  private:
+    typedef Clock clock;
+
+    std::atomic<std::uint64_t> _pushes;
+    std::atomic<std::uint64_t> _pops;
+    std::atomic<std::uint64_t> _overwrites;
+    std::atomic<std::uint64_t> _drops;
+    std::atomic<std::uint64_t> _high_water_mark;
+    std::atomic<std::uint64_t> _full_ns;
+    std::atomic<std::int64_t>  _full_since; // nanoseconds since the epoch of Clock, 0 when not full
+
+    static void add(std::atomic<std::uint64_t>& counter, std::uint64_t n) JM_CB_NOEXCEPT
+    {
+      counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    static std::int64_t now() JM_CB_NOEXCEPT
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+    }
+
+  public:
+    basic_buffer_stats() JM_CB_NOEXCEPT
+      : _pushes(0), _pops(0), _overwrites(0), _drops(0), _high_water_mark(0), _full_ns(0), _full_since(0)
+    {}
+
+    // counters are not carried over when the buffer is copied or moved
+    basic_buffer_stats(const basic_buffer_stats&) JM_CB_NOEXCEPT : basic_buffer_stats() {}
+
+    basic_buffer_stats& operator=(const basic_buffer_stats&) JM_CB_NOEXCEPT { return *this; }
+
+    values snapshot() const JM_CB_NOEXCEPT
+    {
+      values v;
+      v.pushes = _pushes.load(std::memory_order_relaxed);
+      v.pops = _pops.load(std::memory_order_relaxed);
+      v.overwrites = _overwrites.load(std::memory_order_relaxed);
+      v.drops = _drops.load(std::memory_order_relaxed);
+      v.high_water_mark = _high_water_mark.load(std::memory_order_relaxed);
+      v.full_ns = _full_ns.load(std::memory_order_relaxed);
+
+      const std::int64_t since = _full_since.load(std::memory_order_relaxed);
+      if (since != 0)
+        v.full_ns += static_cast<std::uint64_t>(now() - since);
+      return v;
+    }
+
+    /// buffer hooks
+    // n elements were pushed and the buffer now holds size of capacity. also called
+    // with n = 0 when the capacity changed, a buffer that grew is no longer full
+    void on_push(std::size_t n, std::size_t size, std::size_t capacity) JM_CB_NOEXCEPT
+    {
+      add(_pushes, n);
+      if (size > _high_water_mark.load(std::memory_order_relaxed))
+        _high_water_mark.store(size, std::memory_order_relaxed);
+
+      const std::int64_t since = _full_since.load(std::memory_order_relaxed);
+      if (JM_CB_UNLIKELY(size == capacity)) {
+        if (since == 0)
+          _full_since.store(now(), std::memory_order_relaxed);
+      }
+      else if (JM_CB_UNLIKELY(since != 0)) {
+        add(_full_ns, static_cast<std::uint64_t>(now() - since));
+        _full_since.store(0, std::memory_order_relaxed);
+      }
+    }
+
+    void on_pop(std::size_t n) JM_CB_NOEXCEPT
+    {
+      add(_pops, n);
+      const std::int64_t since = _full_since.load(std::memory_order_relaxed);
+      if (JM_CB_UNLIKELY(since != 0) && n != 0) {
+        add(_full_ns, static_cast<std::uint64_t>(now() - since));
+        _full_since.store(0, std::memory_order_relaxed);
+      }
+    }
+
+    void on_overwrite() JM_CB_NOEXCEPT { add(_overwrites, 1); }
+
+    void on_drop() JM_CB_NOEXCEPT { add(_drops, 1); }
+  };
+
+  typedef basic_buffer_stats<> buffer_stats;
+} // namespace jm
+
+#endif // JM_BUFFER_STATS_HPP
@@ -0,0 +1,278 @@
+#ifndef JM_BYTE_RECORD_RING_HPP
+#define JM_BYTE_RECORD_RING_HPP
+
+#include <circular_buffer/config.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace jm {
+  namespace detail {
+    // read / write position, shared between threads only in the concurrent ring
+    template<bool Concurrent>
+    class record_ring_position {
+      std::size_t _value;
+
+    public:
+      record_ring_position() JM_CB_NOEXCEPT : _value(0) {}
+
+      std::size_t load_acquire() const JM_CB_NOEXCEPT { return _value; }
+
+      std::size_t load_relaxed() const JM_CB_NOEXCEPT { return _value; }
+
+      void store_release(std::size_t value) JM_CB_NOEXCEPT { _value = value; }
+    };
+
+    template<>
+    class record_ring_position<true> {
+      alignas(64) std::atomic<std::size_t> _value; // own cache line
+
+    public:
+      record_ring_position() JM_CB_NOEXCEPT : _value(0) {}
+
+      std::size_t load_acquire() const JM_CB_NOEXCEPT { return _value.load(std::memory_order_acquire); }
+
+      std::size_t load_relaxed() const JM_CB_NOEXCEPT { return _value.load(std::memory_order_relaxed); }
+
+      void store_release(std::size_t value) JM_CB_NOEXCEPT { _value.store(value, std::memory_order_release); }
+    };
+  } // namespace detail
+
+  // Notifier of a ring that nobody waits on, every hook compiles away.
+  struct null_ring_notifier {
+    void on_commit() JM_CB_NOEXCEPT {}
+
+    void on_release(std::size_t) JM_CB_NOEXCEPT {}
+
+    void on_full() JM_CB_NOEXCEPT {}
+  };
+
+  // Ring of variable length records, each stored contiguously behind an 8 byte length
+  // header, so a record is written and read in place as one span. A record that does
+  // not fit before the end of the storage is preceded by a skip marker and written at
+  // the start instead. Records are 8 byte aligned.
+  //
+  // With Concurrent = true one producer thread ( try_write / commit ) and one consumer
+  // thread ( read_next / release ) may use the ring at the same time.
+  //
+  // Notifier is told about every commit, every release with the number of records
+  // freed, and every try_write that found the ring full, from the thread that did it;
+  // see eventfd_notifier.hpp.
+  template<bool Concurrent, class Notifier = null_ring_notifier>
+  class basic_byte_record_ring : private Notifier {
+  public:
+    typedef std::size_t size_type;
+
+    // a record readable in place, data is null when there is nothing to read
+    struct record {
+      const char* data;
+      size_type   size;
+
+      bool empty() const JM_CB_NOEXCEPT { return data == JM_CB_NULLPTR; }
+    };
+
+  private:
+    typedef std::uint64_t header_type;
+
+    static JM_CB_CONSTEXPR size_type   header_size = sizeof(header_type);
+    static JM_CB_CONSTEXPR header_type skip_marker = ~header_type(0);
+
+    std::vector<header_type> _storage;
+    size_type                _mask;
+
+    // positions grow without wrapping, storage offsets are taken with & _mask
+    detail::record_ring_position<Concurrent> _write;
+    detail::record_ring_position<Concurrent> _read;
+
+    // producer side
+    size_type _reserved; // position of the header of the record being written
+    size_type _reserved_size;
+    // consumer side
+    size_type _reading_size;
+
+    static JM_CB_CONSTEXPR size_type aligned(size_type size) JM_CB_NOEXCEPT
+    {
+      return (size + header_size - 1) & ~(header_size - 1);
+    }
+
+    char* bytes() JM_CB_NOEXCEPT { return reinterpret_cast<char*>(_storage.data()); }
+
+    const char* bytes() const JM_CB_NOEXCEPT { return reinterpret_cast<const char*>(_storage.data()); }
+
+    void write_header(size_type position, header_type value) JM_CB_NOEXCEPT
+    {
+      std::memcpy(bytes() + (position & _mask), &value, header_size);
+    }
+
+    header_type read_header(size_type position) const JM_CB_NOEXCEPT
+    {
+      header_type value;
+      std::memcpy(&value, bytes() + (position & _mask), header_size);
+      return value;
+    }
+
+    // frees the records consumed so far when it goes out of scope, even by an exception
+    struct consume_guard {
+      basic_byte_record_ring& ring;
+      size_type               position;
+      size_type               count;
+
+      ~consume_guard()
+      {
+        if (position == ring._read.load_relaxed())
+          return;
+        ring._read.store_release(position);
+        if (count != 0)
+          static_cast<Notifier&>(ring).on_release(count);
+      }
+    };
+
+  public:
+    // capacity in bytes, headers included, rounded up to a power of two. the other
+    // arguments construct the notifier
+    template<class... NotifierArgs>
+    explicit basic_byte_record_ring(size_type capacity, NotifierArgs&&... notifier_args)
+      : Notifier(std::forward<NotifierArgs>(notifier_args)...), _storage(), _mask(0), _write(), _read(), _reserved(0), _reserved_size(0), _reading_size(0)
+    {
+      size_type bytes = 4 * header_size;
+      while (bytes < capacity)
+        bytes *= 2;
+      _storage.resize(bytes / header_size);
+      _mask = bytes - 1;
+    }
+
+    basic_byte_record_ring(const basic_byte_record_ring&) = delete;
+    basic_byte_record_ring& operator=(const basic_byte_record_ring&) = delete;
+
+    /// capacity
+    size_type capacity() const JM_CB_NOEXCEPT { return _mask + 1; }
+
+    // Largest record accepted. Positions are never reset, so an empty ring may have to
+    // place a record behind a skip marker; half the capacity fits at any offset.
+    size_type max_record_size() const JM_CB_NOEXCEPT { return capacity() / 2 - header_size; }
+
+    // bytes taken by unread records, headers and padding included
+    size_type used_bytes() const JM_CB_NOEXCEPT { return _write.load_acquire() - _read.load_acquire(); }
+
+    bool empty() const JM_CB_NOEXCEPT { return used_bytes() == 0; }
+
+    Notifier& notifier() JM_CB_NOEXCEPT { return *this; }
+
+    /// producer
+    // reserves size contiguous bytes for a record, null if it does not fit right now.
+    // the record becomes readable on commit()
+    char* try_write(size_type size) JM_CB_NOEXCEPT
+    {
+      if (JM_CB_UNLIKELY(size > max_record_size()))
+        return JM_CB_NULLPTR;
+
+      const size_type needed = header_size + aligned(size);
+
+      size_type       position = _write.load_relaxed();
+      const size_type until_end = capacity() - (position & _mask);
+      const size_type available = capacity() - (position - _read.load_acquire());
+
+      if (JM_CB_UNLIKELY(needed > until_end)) {
+        if (until_end + needed > available) {
+          Notifier::on_full();
+          return JM_CB_NULLPTR;
+        }
+
+        write_header(position, skip_marker);
+        position += until_end;
+      }
+      else if (needed > available) {
+        Notifier::on_full();
+        return JM_CB_NULLPTR;
+      }
+
+      _reserved = position;
+      _reserved_size = size;
+      return bytes() + ((position + header_size) & _mask);
+    }
+
+    // publishes the record reserved by the last successful try_write
+    void commit() JM_CB_NOEXCEPT
+    {
+      write_header(_reserved, static_cast<header_type>(_reserved_size));
+      _write.store_release(_reserved + header_size + aligned(_reserved_size));
+      Notifier::on_commit();
+    }
+
+    // try_write + memcpy + commit
+    bool write(const void* data, size_type size) JM_CB_NOEXCEPT
+    {
+      char* dest = try_write(size);
+      if (dest == JM_CB_NULLPTR)
+        return false;
+
+      std::memcpy(dest, data, size);
+      commit();
+      return true;
+    }
+
+    /// consumer
+    // the oldest record, which stays readable until release()
+    record read_next() JM_CB_NOEXCEPT
+    {
+      size_type       position = _read.load_relaxed();
+      const size_type written = _write.load_acquire();
+      if (position == written)
+        return record{ JM_CB_NULLPTR, 0 };
+
+      header_type header = read_header(position);
+      if (JM_CB_UNLIKELY(header == skip_marker)) {
+        position += capacity() - (position & _mask);
+        _read.store_release(position);
+        if (position == written)
+          return record{ JM_CB_NULLPTR, 0 };
+        header = read_header(position);
+      }
+
+      _reading_size = static_cast<size_type>(header);
+      return record{ bytes() + ((position + header_size) & _mask), _reading_size };
+    }
+
+    // frees the record returned by the last read_next
+    void release() JM_CB_NOEXCEPT
+    {
+      _read.store_release(_read.load_relaxed() + header_size + aligned(_reading_size));
+      Notifier::on_release(1);
+    }
+
+    // Calls f(record) in place on up to max readable records, then frees them with a
+    // single store of the read position instead of one per record. A record whose
+    // callback threw stays unread. Returns the number of records consumed, 0 when there
+    // was nothing to read; it never waits.
+    template<class F>
+    size_type try_consume(F f, size_type max = std::numeric_limits<size_type>::max())
+    {
+      consume_guard   guard{ *this, _read.load_relaxed(), 0 };
+      const size_type written = _write.load_acquire();
+      while (guard.count < max && guard.position != written) {
+        header_type header = read_header(guard.position);
+        if (JM_CB_UNLIKELY(header == skip_marker)) {
+          guard.position += capacity() - (guard.position & _mask);
+          if (guard.position == written)
+            break;
+          header = read_header(guard.position);
+        }
+
+        const size_type size = static_cast<size_type>(header);
+        f(record{ bytes() + ((guard.position + header_size) & _mask), size });
+        guard.position += header_size + aligned(size);
+        ++guard.count;
+      }
+      return guard.count;
+    }
+  };
+
+  typedef basic_byte_record_ring<false> byte_record_ring;
+  typedef basic_byte_record_ring<true>  spsc_byte_record_ring;
+} // namespace jm
+
+#endif // JM_BYTE_RECORD_RING_HPP
@@ -0,0 +1,128 @@
+#ifndef JM_CASCADING_BUFFER_HPP
+#define JM_CASCADING_BUFFER_HPP
+
+#include <circular_buffer/static_circular_buffer.hpp>
+
+namespace jm {
+  // min / max / sum / last of a block of samples
+  template<typename T>
+  struct consolidated_sample {
+    T           min;
+    T           max;
+    T           sum;
+    T           last;
+    std::size_t count;
+
+    JM_CB_CONSTEXPR T mean() const { return sum / static_cast<T>(count); }
+  };
+
+  // Round robin database style history: level 0 holds the last N raw samples, every
+  // next level holds the last N consolidations of Factor samples of the level below.
+  // Blocks are consolidated incrementally while they are being filled, so a push costs
+  // O(1) amortized, and all the memory is fixed at compile time.
+  template<typename T, std::size_t N, std::size_t Factor, std::size_t Levels>
+  class cascading_buffer {
+    static_assert(Factor > 1, "Factor must be greater than 1");
+    static_assert(Levels > 1, "there is no point in a single level cascade");
+
+  public:
+    typedef T                                      value_type;
+    typedef std::size_t                            size_type;
+    typedef consolidated_sample<T>                 sample_type;
+    typedef static_circular_buffer<T, N>           raw_buffer;
+    typedef static_circular_buffer<sample_type, N> level_buffer;
+
+  private:
+    raw_buffer                           _raw;
+    std::array<level_buffer, Levels - 1> _levels;
+    std::array<sample_type, Levels - 1>  _pending; // block being filled for each level
+    std::array<size_type, Levels - 1>    _pending_children;
+
+    static void merge(sample_type& into, const sample_type& block) JM_CB_NOEXCEPT
+    {
+      if (into.count == 0) {
+        into = block;
+        return;
+      }
+
+      into.min = std::min(into.min, block.min);
+      into.max = std::max(into.max, block.max);
+      into.sum = into.sum + block.sum;
+      into.last = block.last;
+      into.count += block.count;
+    }
+
+  public:
+    cascading_buffer() : _raw(), _levels(), _pending(), _pending_children() { clear(); }
+
+    static JM_CB_CONSTEXPR size_type levels() JM_CB_NOEXCEPT { return Levels; }
+
+    static JM_CB_CONSTEXPR size_type factor() JM_CB_NOEXCEPT { return Factor; }
+
+    // raw samples each entry of a level stands for
+    static JM_CB_CONSTEXPR size_type resolution(size_type level) JM_CB_NOEXCEPT
+    {
+      return level == 0 ? 1 : Factor * resolution(level - 1);
+    }
+
+    /// element access
+    const raw_buffer& raw() const JM_CB_NOEXCEPT { return _raw; }
+
+    // consolidated history of level 1 .. Levels - 1
+    const level_buffer& level(size_type i) const JM_CB_NOEXCEPT
+    {
+      JM_ASSERT(i != 0 && i < Levels, "level 0 holds raw samples, use raw()");
+      return _levels[i - 1];
+    }
+
+    // consolidation of the newest count entries of a level
+    sample_type summarize(size_type level, size_type count) const JM_CB_NOEXCEPT
+    {
+      JM_ASSERT(level < Levels, "level out of range");
+      sample_type result = sample_type();
+
+      if (level == 0) {
+        const size_type first = _raw.size() - std::min(count, _raw.size());
+        for (size_type i = first; i < _raw.size(); ++i)
+          merge(result, sample_type{ _raw[i], _raw[i], _raw[i], _raw[i], 1 });
+      }
+      else {
+        const level_buffer& entries = _levels[level - 1];
+        const size_type     first = entries.size() - std::min(count, entries.size());
+        for (size_type i = first; i < entries.size(); ++i)
+          merge(result, entries[i]);
+      }
+      return result;
+    }
+
+    /// modifiers
+    void push(const value_type& value)
+    {
+      _raw.push_back(value);
+
+      sample_type block{ value, value, value, value, 1 };
+      for (size_type i = 0; i < Levels - 1; ++i) {
+        merge(_pending[i], block);
+        if (JM_CB_LIKELY(++_pending_children[i] != Factor))
+          return;
+
+        block = _pending[i];
+        _levels[i].push_back(block);
+        _pending[i].count = 0;
+        _pending_children[i] = 0;
+      }
+    }
+
+    void clear()
+    {
+      _raw.clear();
+      for (size_type i = 0; i < Levels - 1; ++i) {
+        _levels[i].clear();
+        _pending[i] = sample_type();
+        _pending_children[i] = 0;
+      }
+    }
+  };
+} // namespace jm
+
+#endif // JM_CASCADING_BUFFER_HPP
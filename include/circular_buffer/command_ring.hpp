@@ -0,0 +1,157 @@
+#ifndef JM_COMMAND_RING_HPP
+#define JM_COMMAND_RING_HPP
+
+#include <circular_buffer/byte_record_ring.hpp>
+
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace jm {
+  template<class Signature, bool Concurrent = false>
+  class basic_command_ring;
+
+  // Ring of callables of any type and size, emplaced inline into a byte_record_ring.
+  // Each record starts with the invoke / destroy thunks of its callable, followed by
+  // the callable itself, aligned as its type requires. Commands are dispatched and
+  // destroyed in order without any allocation.
+  template<class... Args, bool Concurrent>
+  class basic_command_ring<void(Args...), Concurrent> {
+  public:
+    typedef std::size_t size_type;
+
+  private:
+    struct header {
+      void (*invoke)(void*, Args&&...);
+      void (*destroy)(void*);
+    };
+
+    basic_byte_record_ring<Concurrent> _records;
+
+    // records are aligned to 8 bytes, over aligned types get padded further
+    template<class F>
+    static F* object(void* after_header) JM_CB_NOEXCEPT
+    {
+      const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(after_header);
+      const std::uintptr_t align = alignof(F);
+      return reinterpret_cast<F*>((address + align - 1) & ~(align - 1));
+    }
+
+    template<class F>
+    static void invoke_thunk(void* p, Args&&... args)
+    {
+      (*object<F>(p))(std::forward<Args>(args)...);
+    }
+
+    template<class F>
+    static void destroy_thunk(void* p) JM_CB_NOEXCEPT
+    {
+      object<F>(p)->~F();
+    }
+
+    static void* after_header(const char* record) JM_CB_NOEXCEPT
+    {
+      return const_cast<char*>(record) + sizeof(header);
+    }
+
+    static const header& header_of(const char* record) JM_CB_NOEXCEPT
+    {
+      return *reinterpret_cast<const header*>(record);
+    }
+
+    // destroys the oldest command even if it threw while being invoked
+    struct release_guard {
+      basic_byte_record_ring<Concurrent>& records;
+      const char*                         record;
+
+      ~release_guard()
+      {
+        header_of(record).destroy(after_header(record));
+        records.release();
+      }
+    };
+
+    // args are forwarded as Args, without being copied
+    bool dispatch_one(Args&... args)
+    {
+      const auto record = _records.read_next();
+      if (record.empty())
+        return false;
+
+      release_guard guard{ _records, record.data };
+      header_of(record.data).invoke(after_header(record.data), std::forward<Args>(args)...);
+      return true;
+    }
+
+  public:
+    // capacity in bytes of the arena, headers and padding included
+    explicit basic_command_ring(size_type capacity) : _records(capacity) {}
+
+    basic_command_ring(const basic_command_ring&) = delete;
+    basic_command_ring& operator=(const basic_command_ring&) = delete;
+
+    ~basic_command_ring() { clear(); }
+
+    /// capacity
+    size_type capacity() const JM_CB_NOEXCEPT { return _records.capacity(); }
+
+    bool empty() const JM_CB_NOEXCEPT { return _records.empty(); }
+
+    /// producer
+    // constructs an F from args inside the ring, false if it does not fit right now
+    template<class F, class... CtorArgs>
+    bool try_emplace(CtorArgs&&... args)
+    {
+      static_assert(std::is_nothrow_destructible<F>::value, "commands must not throw from their destructor");
+
+      const size_type size = sizeof(header) + (alignof(F) > 8 ? alignof(F) - 8 : 0) + sizeof(F);
+      char*           record = _records.try_write(size);
+      if (record == JM_CB_NULLPTR)
+        return false;
+
+      // nothing is committed if the constructor throws
+      ::new (static_cast<void*>(object<F>(after_header(record)))) F(std::forward<CtorArgs>(args)...);
+      ::new (static_cast<void*>(record)) header{ &invoke_thunk<F>, &destroy_thunk<F> };
+      _records.commit();
+      return true;
+    }
+
+    template<class F>
+    bool try_push(F&& f)
+    {
+      return try_emplace<typename std::decay<F>::type>(std::forward<F>(f));
+    }
+
+    /// consumer
+    // invokes and destroys the oldest command, false if there was none
+    bool dispatch(Args... args) { return dispatch_one(args...); }
+
+    // dispatches every command available, returns how many were run. All of them see
+    // the same argument objects, forwarded as dispatch does, so a command moving from
+    // an argument leaves it moved from for the next ones
+    size_type dispatch_all(Args&... args)
+    {
+      size_type count = 0;
+      while (dispatch_one(args...))
+        ++count;
+      return count;
+    }
+
+    // destroys the pending commands without running them
+    void clear() JM_CB_NOEXCEPT
+    {
+      for (auto record = _records.read_next(); !record.empty(); record = _records.read_next()) {
+        header_of(record.data).destroy(after_header(record.data));
+        _records.release();
+      }
+    }
+  };
+
+  template<class Signature>
+  using command_ring = basic_command_ring<Signature, false>;
+
+  template<class Signature>
+  using spsc_command_ring = basic_command_ring<Signature, true>;
+} // namespace jm
+
+#endif // JM_COMMAND_RING_HPP
@@ -0,0 +1,435 @@
+#ifndef JM_COMPRESSED_SERIES_HPP
+#define JM_COMPRESSED_SERIES_HPP
+
+#include <circular_buffer/dynamic_circular_buffer.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+namespace jm {
+  namespace detail {
+    inline unsigned count_leading_zeros(std::uint64_t x) JM_CB_NOEXCEPT
+    {
+#if defined(__GNUC__) || defined(__clang__)
+      return static_cast<unsigned>(__builtin_clzll(x));
+#else
+      unsigned n = 0;
+      for (std::uint64_t bit = std::uint64_t(1) << 63; !(x & bit); bit >>= 1)
+        ++n;
+      return n;
+#endif
+    }
+
+    inline unsigned count_trailing_zeros(std::uint64_t x) JM_CB_NOEXCEPT
+    {
+#if defined(__GNUC__) || defined(__clang__)
+      return static_cast<unsigned>(__builtin_ctzll(x));
+#else
+      unsigned n = 0;
+      for (; !(x & 1); x >>= 1)
+        ++n;
+      return n;
+#endif
+    }
+
+    inline JM_CB_CONSTEXPR std::uint64_t low_bits(unsigned n) JM_CB_NOEXCEPT
+    {
+      return n >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << n) - 1;
+    }
+
+    // MSB first bit stream over a fixed array of words, which must start zeroed
+    template<std::size_t Words>
+    struct bit_stream {
+      std::uint64_t words[Words];
+
+      // writes the low n bits of value at pos, 1 <= n <= 64
+      void put(std::size_t& pos, std::uint64_t value, unsigned n) JM_CB_NOEXCEPT
+      {
+        const std::size_t word = pos >> 6;
+        const unsigned    room = 64 - static_cast<unsigned>(pos & 63);
+        if (n <= room)
+          words[word] |= value << (room - n);
+        else {
+          words[word] |= value >> (n - room);
+          words[word + 1] |= value << (64 - (n - room));
+        }
+        pos += n;
+      }
+
+      std::uint64_t get(std::size_t& pos, unsigned n) const JM_CB_NOEXCEPT
+      {
+        const std::size_t word = pos >> 6;
+        const unsigned    room = 64 - static_cast<unsigned>(pos & 63);
+        std::uint64_t     value;
+        if (n <= room)
+          value = (words[word] >> (room - n)) & low_bits(n);
+        else {
+          const unsigned rest = n - room;
+          value = ((words[word] & low_bits(room)) << rest) | (words[word + 1] >> (64 - rest));
+        }
+        pos += n;
+        return value;
+      }
+    };
+  } // namespace detail
+
+  // Time series ring compressed Gorilla style: timestamps are stored as delta of
+  // deltas and values as the XOR with the previous value, both with variable length
+  // codes. Points are packed into fixed size blocks kept in a dynamic_circular_buffer,
+  // so memory is fixed and whole blocks are evicted from the head once it is full.
+  // V must be an 8 byte trivially copyable type ( double, std::int64_t, ... ).
+  template<typename V, std::size_t BlockBytes = 4096>
+  class compressed_series {
+    static_assert(sizeof(V) == 8 && std::is_trivially_copyable<V>::value,
+                  "values are encoded as 64 bit patterns");
+    static_assert(BlockBytes % 8 == 0 && BlockBytes >= 64, "BlockBytes must be a multiple of 8 and >= 64");
+
+  public:
+    typedef V             value_type;
+    typedef std::int64_t  time_type;
+    typedef std::size_t   size_type;
+
+    struct point {
+      time_type  time;
+      value_type value;
+    };
+
+    class block {
+      friend class compressed_series;
+
+      // largest encoding of a point: 4 + 64 bits of timestamp, 2 + 5 + 6 + 64 of value
+      static JM_CB_CONSTEXPR std::size_t max_point_bits = 145;
+      static JM_CB_CONSTEXPR std::size_t capacity_bits = BlockBytes * 8;
+
+      detail::bit_stream<BlockBytes / 8> _stream;
+      std::size_t                        _bits;
+      size_type                          _count;
+      time_type                          _first_time;
+      std::uint64_t                      _first_value;
+      // encoder state
+      time_type                          _last_time;
+      std::uint64_t                      _last_delta;
+      std::uint64_t                      _last_value;
+      unsigned                           _leading;
+      unsigned                           _trailing;
+
+      static std::uint64_t to_bits(const value_type& value) JM_CB_NOEXCEPT
+      {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+      }
+
+      static value_type from_bits(std::uint64_t bits) JM_CB_NOEXCEPT
+      {
+        value_type value;
+        std::memcpy(&value, &bits, sizeof(bits));
+        return value;
+      }
+
+      bool try_append(time_type time, const value_type& value) JM_CB_NOEXCEPT
+      {
+        const std::uint64_t bits = to_bits(value);
+        if (_count == 0) {
+          _first_time = _last_time = time;
+          _first_value = _last_value = bits;
+          _last_delta = 0;
+          _leading = 64;
+          _trailing = 0;
+          _count = 1;
+          return true;
+        }
+
+        if (_bits + max_point_bits > capacity_bits)
+          return false;
+
+        // timestamps, in unsigned arithmetic so that overflow wraps the same way on decode
+        const std::uint64_t delta = static_cast<std::uint64_t>(time) - static_cast<std::uint64_t>(_last_time);
+        const std::uint64_t dod = delta - _last_delta;
+        const std::int64_t  signed_dod = static_cast<std::int64_t>(dod);
+        if (dod == 0)
+          _stream.put(_bits, 0, 1);
+        else if (signed_dod >= -63 && signed_dod <= 64) {
+          _stream.put(_bits, 2, 2);
+          _stream.put(_bits, dod + 63, 7);
+        }
+        else if (signed_dod >= -255 && signed_dod <= 256) {
+          _stream.put(_bits, 6, 3);
+          _stream.put(_bits, dod + 255, 9);
+        }
+        else if (signed_dod >= -2047 && signed_dod <= 2048) {
+          _stream.put(_bits, 14, 4);
+          _stream.put(_bits, dod + 2047, 12);
+        }
+        else {
+          _stream.put(_bits, 15, 4);
+          _stream.put(_bits, dod, 64);
+        }
+
+        // values
+        const std::uint64_t x = bits ^ _last_value;
+        if (x == 0)
+          _stream.put(_bits, 0, 1);
+        else {
+          const unsigned leading = std::min(detail::count_leading_zeros(x), 31u);
+          const unsigned trailing = detail::count_trailing_zeros(x);
+          if (leading >= _leading && trailing >= _trailing) {
+            _stream.put(_bits, 2, 2);
+            _stream.put(_bits, x >> _trailing, 64 - _leading - _trailing);
+          }
+          else {
+            const unsigned meaningful = 64 - leading - trailing;
+            _stream.put(_bits, 3, 2);
+            _stream.put(_bits, leading, 5);
+            _stream.put(_bits, meaningful & 63, 6);
+            _stream.put(_bits, x >> trailing, meaningful);
+            _leading = leading;
+            _trailing = trailing;
+          }
+        }
+
+        _last_time = time;
+        _last_delta = delta;
+        _last_value = bits;
+        ++_count;
+        return true;
+      }
+
+    public:
+      // streaming decoder over the points of a block
+      class const_iterator {
+        const block*  _block;
+        std::size_t   _bits;
+        size_type     _left;
+        point         _point;
+        std::uint64_t _delta;
+        std::uint64_t _value;
+        unsigned      _leading;
+        unsigned      _trailing;
+
+        void decode() JM_CB_NOEXCEPT
+        {
+          const auto& stream = _block->_stream;
+
+          std::uint64_t dod = 0;
+          if (stream.get(_bits, 1) != 0) {
+            if (stream.get(_bits, 1) == 0)
+              dod = stream.get(_bits, 7) - 63;
+            else if (stream.get(_bits, 1) == 0)
+              dod = stream.get(_bits, 9) - 255;
+            else if (stream.get(_bits, 1) == 0)
+              dod = stream.get(_bits, 12) - 2047;
+            else
+              dod = stream.get(_bits, 64);
+          }
+          _delta += dod;
+          _point.time = static_cast<time_type>(static_cast<std::uint64_t>(_point.time) + _delta);
+
+          if (stream.get(_bits, 1) != 0) {
+            if (stream.get(_bits, 1) != 0) {
+              _leading = static_cast<unsigned>(stream.get(_bits, 5));
+              unsigned meaningful = static_cast<unsigned>(stream.get(_bits, 6));
+              if (meaningful == 0)
+                meaningful = 64;
+              _trailing = 64 - _leading - meaningful;
+            }
+            _value ^= stream.get(_bits, 64 - _leading - _trailing) << _trailing;
+            _point.value = from_bits(_value);
+          }
+        }
+
+      public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef point                     value_type;
+        typedef std::ptrdiff_t            difference_type;
+        typedef const point*              pointer;
+        typedef const point&              reference;
+
+        const_iterator() JM_CB_NOEXCEPT
+          : _block(JM_CB_NULLPTR), _bits(0), _left(0), _point(), _delta(0), _value(0), _leading(0), _trailing(0)
+        {}
+
+        explicit const_iterator(const block* b) JM_CB_NOEXCEPT
+          : _block(b), _bits(0), _left(b->_count), _point(), _delta(0), _value(b->_first_value), _leading(0),
+            _trailing(0)
+        {
+          _point.time = b->_first_time;
+          _point.value = from_bits(_value);
+        }
+
+        reference operator*() const JM_CB_NOEXCEPT { return _point; }
+
+        pointer operator->() const JM_CB_NOEXCEPT { return &_point; }
+
+        const_iterator& operator++() JM_CB_NOEXCEPT
+        {
+          if (--_left != 0)
+            decode();
+          return *this;
+        }
+
+        const_iterator operator++(int) JM_CB_NOEXCEPT
+        {
+          const_iterator temp = *this;
+          ++*this;
+          return temp;
+        }
+
+        bool operator==(const const_iterator& rhs) const JM_CB_NOEXCEPT { return _left == rhs._left; }
+
+        bool operator!=(const const_iterator& rhs) const JM_CB_NOEXCEPT { return _left != rhs._left; }
+      };
+
+      block() JM_CB_NOEXCEPT
+        : _stream(), _bits(0), _count(0), _first_time(0), _first_value(0), _last_time(0), _last_delta(0),
+          _last_value(0), _leading(64), _trailing(0)
+      {}
+
+      size_type size() const JM_CB_NOEXCEPT { return _count; }
+
+      // bits of the encoded stream, not counting the first point kept in the header
+      std::size_t bits() const JM_CB_NOEXCEPT { return _bits; }
+
+      time_type first_time() const JM_CB_NOEXCEPT { return _first_time; }
+
+      time_type last_time() const JM_CB_NOEXCEPT { return _last_time; }
+
+      const_iterator begin() const JM_CB_NOEXCEPT { return _count ? const_iterator(this) : end(); }
+
+      const_iterator end() const JM_CB_NOEXCEPT { return const_iterator(); }
+    };
+
+    // streaming decoder over every point, oldest first
+    class const_iterator {
+      const compressed_series*        _series;
+      size_type                       _block;
+      typename block::const_iterator _point;
+
+      void skip_empty() JM_CB_NOEXCEPT
+      {
+        while (_block != _series->_blocks.size() && _point == typename block::const_iterator()) {
+          if (++_block != _series->_blocks.size())
+            _point = _series->_blocks[_block].begin();
+        }
+      }
+
+    public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef point                     value_type;
+      typedef std::ptrdiff_t            difference_type;
+      typedef const point*              pointer;
+      typedef const point&              reference;
+
+      const_iterator() JM_CB_NOEXCEPT : _series(JM_CB_NULLPTR), _block(0), _point() {}
+
+      const_iterator(const compressed_series* series, size_type first_block) JM_CB_NOEXCEPT
+        : _series(series), _block(first_block), _point()
+      {
+        if (_block != _series->_blocks.size())
+          _point = _series->_blocks[_block].begin();
+        skip_empty();
+      }
+
+      reference operator*() const JM_CB_NOEXCEPT { return *_point; }
+
+      pointer operator->() const JM_CB_NOEXCEPT { return _point.operator->(); }
+
+      const_iterator& operator++() JM_CB_NOEXCEPT
+      {
+        ++_point;
+        skip_empty();
+        return *this;
+      }
+
+      const_iterator operator++(int) JM_CB_NOEXCEPT
+      {
+        const_iterator temp = *this;
+        ++*this;
+        return temp;
+      }
+
+      bool operator==(const const_iterator& rhs) const JM_CB_NOEXCEPT
+      {
+        return _block == rhs._block && _point == rhs._point;
+      }
+
+      bool operator!=(const const_iterator& rhs) const JM_CB_NOEXCEPT { return !(*this == rhs); }
+    };
+
+  private:
+    dynamic_circular_buffer<block> _blocks;
+    size_type                      _size;
+
+  public:
+    explicit compressed_series(size_type max_blocks) : _blocks(max_blocks), _size(0) {}
+
+    /// capacity
+    bool empty() const JM_CB_NOEXCEPT { return _size == 0; }
+
+    size_type size() const JM_CB_NOEXCEPT { return _size; }
+
+    size_type block_count() const JM_CB_NOEXCEPT { return _blocks.size(); }
+
+    size_type max_blocks() const JM_CB_NOEXCEPT { return _blocks.max_size(); }
+
+    // bytes taken by the encoded points, block headers included
+    size_type compressed_bytes() const JM_CB_NOEXCEPT
+    {
+      size_type bytes = 0;
+      for (const auto& b : _blocks)
+        bytes += (b.bits() + 7) / 8 + (sizeof(block) - BlockBytes);
+      return bytes;
+    }
+
+    /// element access
+    // blocks are ordered oldest first, each one can be decoded on its own
+    const block& block_at(size_type i) const JM_CB_NOEXCEPT { return _blocks[i]; }
+
+    // index of the first block that may hold points at or after time
+    size_type find_block(time_type time) const JM_CB_NOEXCEPT
+    {
+      size_type first = 0, count = _blocks.size();
+      while (count != 0) {
+        const size_type step = count / 2;
+        if (_blocks[first + step].last_time() < time) {
+          first += step + 1;
+          count -= step + 1;
+        }
+        else
+          count = step;
+      }
+      return first;
+    }
+
+    const_iterator begin() const JM_CB_NOEXCEPT { return const_iterator(this, 0); }
+
+    const_iterator end() const JM_CB_NOEXCEPT { return const_iterator(this, _blocks.size()); }
+
+    // iterator to the first point of block i
+    const_iterator block_begin(size_type i) const JM_CB_NOEXCEPT { return const_iterator(this, i); }
+
+    /// modifiers
+    void push(time_type time, const value_type& value)
+    {
+      if (JM_CB_LIKELY(!_blocks.empty()) && JM_CB_LIKELY(_blocks.back().try_append(time, value))) {
+        ++_size;
+        return;
+      }
+
+      if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_blocks.full()))
+        _size -= _blocks.front().size();
+
+      _blocks.push_back(block());
+      _blocks.back().try_append(time, value);
+      ++_size;
+    }
+
+    void clear()
+    {
+      _blocks.clear();
+      _size = 0;
+    }
+  };
+} // namespace jm
+
+#endif // JM_COMPRESSED_SERIES_HPP
@@ -3,11 +3,20 @@
 
 #define JM_CIRCULAR_BUFFER_CXX14
 
+// constexpr destructors and std::construct_at, static_circular_buffer is then usable
+// in constant expressions
+#if defined(__cpp_constexpr_dynamic_alloc) && __cpp_constexpr_dynamic_alloc >= 201907L
+#define JM_CIRCULAR_BUFFER_CXX20
+#endif
+
 #include <iterator>
 #include <algorithm>
 #include <stdexcept>
+#include <utility>
 
 #include <array>
+#include <memory>
+#include <new>
 #include <vector>
 
 #if !defined(JM_CIRCULAR_BUFFER_CXX_OLD)
@@ -42,6 +51,14 @@
 #define JM_CB_CXX14_INIT_0
 #endif
 
+#ifdef JM_CIRCULAR_BUFFER_CXX20
+#define JM_CB_CXX20_CONSTEXPR constexpr
+#define JM_CB_IS_CONSTANT_EVALUATED() ::std::is_constant_evaluated()
+#else
+#define JM_CB_CXX20_CONSTEXPR
+#define JM_CB_IS_CONSTANT_EVALUATED() false
+#endif
+
 #if defined(__GNUC__)
 #define JM_CB_LIKELY(x) __builtin_expect(x, 1)
 #define JM_CB_UNLIKELY(x) __builtin_expect(x, 0)
@@ -63,6 +80,13 @@
 #endif // !JM_CB_LIKELY
 
 
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#define JM_CB_RESTRICT __restrict
+#else
+#define JM_CB_RESTRICT
+#endif
+
+
 #if defined(JM_CIRCULAR_BUFFER_LIKELY_FULL) // optimization if you know if the buffer will
 // likely be full or not
 #define JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(expr) JM_CB_LIKELY(expr)
@@ -83,6 +107,17 @@ namespace jm::detail {
     return (std::move(arg));
   }
 
+  // placement new, which constant expressions only accept as std::construct_at
+  template<class T, class... Args>
+  JM_CB_CXX20_CONSTEXPR T* construct_at(T* p, Args&&... args)
+  {
+#ifdef JM_CIRCULAR_BUFFER_CXX20
+    return std::construct_at(p, std::forward<Args>(args)...);
+#else
+    return ::new (static_cast<void*>(p)) T(std::forward<Args>(args)...);
+#endif
+  }
+
   template<class T, bool = JM_CB_IS_TRIVIALLY_DESTRUCTIBLE(T)>
   union optional_storage {
     struct empty_t {
@@ -104,7 +139,7 @@ namespace jm::detail {
       : _value(std::move(value))
     {}
 
-    ~optional_storage() {}
+    JM_CB_CXX20_CONSTEXPR ~optional_storage() {}
   };
 
   template<class T>
@@ -127,6 +162,42 @@ namespace jm::detail {
 
     ~optional_storage() = default;
   };
+
+  // The N slots of a static_circular_buffer behind one union whose active member is
+  // empty. Constructing it writes nothing, so a ring of any size is created without
+  // touching its pages, and it is a constant expression, so buffers at namespace scope
+  // are constant initialized.
+  template<class T, std::size_t N>
+  union slot_array {
+    typedef optional_storage<T> value_type;
+
+    struct empty_t {
+    };
+
+    empty_t    _empty;
+    value_type _slots[N];
+
+    inline explicit JM_CB_CONSTEXPR slot_array() JM_CB_NOEXCEPT : _empty()
+    {}
+
+    JM_CB_CXX20_CONSTEXPR ~slot_array() {}
+
+    // makes every slot, empty, the active member. Constant evaluation needs all of them
+    // initialized once one holds an element; nothing is written at run time
+    JM_CB_CXX20_CONSTEXPR void activate() JM_CB_NOEXCEPT
+    {
+      for (std::size_t i = 0; i != N; ++i)
+        detail::construct_at(JM_CB_ADDRESSOF(_slots[i]));
+    }
+
+    static JM_CB_CONSTEXPR std::size_t size() JM_CB_NOEXCEPT { return N; }
+
+    JM_CB_CXX14_CONSTEXPR value_type* data() JM_CB_NOEXCEPT { return _slots; }
+    JM_CB_CONSTEXPR const value_type* data() const JM_CB_NOEXCEPT { return _slots; }
+
+    JM_CB_CXX14_CONSTEXPR value_type& operator[](std::size_t i) JM_CB_NOEXCEPT { return _slots[i]; }
+    JM_CB_CONSTEXPR const value_type& operator[](std::size_t i) const JM_CB_NOEXCEPT { return _slots[i]; }
+  };
 }
 
 #endif // JM_CIRCULAR_BUFFER_CONFIG_HPP
\ No newline at end of file
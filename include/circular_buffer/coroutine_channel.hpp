@@ -0,0 +1,308 @@
+#ifndef JM_COROUTINE_CHANNEL_HPP
+#define JM_COROUTINE_CHANNEL_HPP
+
+#include <circular_buffer/dynamic_circular_buffer.hpp>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define JM_CB_HAS_COROUTINES
+#endif
+#endif
+
+#ifdef JM_CB_HAS_COROUTINES
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace jm {
+  // Fire and forget coroutine, started by spawn() and destroyed when it finishes.
+  struct detached_task {
+    struct promise_type {
+      detached_task get_return_object() JM_CB_NOEXCEPT
+      {
+        return detached_task{ std::coroutine_handle<promise_type>::from_promise(*this) };
+      }
+
+      std::suspend_always initial_suspend() JM_CB_NOEXCEPT { return {}; }
+
+      std::suspend_never final_suspend() JM_CB_NOEXCEPT { return {}; }
+
+      void return_void() JM_CB_NOEXCEPT {}
+
+      void unhandled_exception() { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+  };
+
+  // schedules the first resumption of task on executor
+  template<class Executor>
+  void spawn(Executor& executor, detached_task task)
+  {
+    executor.post(task.handle);
+  }
+
+  // Single threaded run queue: coroutines run one after another on the thread
+  // calling run(), which returns once nothing is ready anymore.
+  class inline_scheduler {
+    std::deque<std::coroutine_handle<>> _ready;
+
+  public:
+    void post(std::coroutine_handle<> handle) { _ready.push_back(handle); }
+
+    // resumes ready coroutines until there are none, returns how many were resumed
+    std::size_t run()
+    {
+      std::size_t resumed = 0;
+      for (; !_ready.empty(); ++resumed) {
+        const std::coroutine_handle<> handle = _ready.front();
+        _ready.pop_front();
+        handle.resume();
+      }
+      return resumed;
+    }
+  };
+
+  // Fixed size pool of threads resuming posted coroutines, mostly for testing
+  // channels shared between threads.
+  class thread_pool_executor {
+    std::mutex                          _mutex;
+    std::condition_variable             _ready_cv;
+    std::deque<std::coroutine_handle<>> _ready;
+    bool                                _stop;
+    std::vector<std::thread>            _threads;
+
+    void work()
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      for (;;) {
+        _ready_cv.wait(lock, [this] { return _stop || !_ready.empty(); });
+        if (_ready.empty())
+          return;
+
+        const std::coroutine_handle<> handle = _ready.front();
+        _ready.pop_front();
+        lock.unlock();
+        handle.resume();
+        lock.lock();
+      }
+    }
+
+  public:
+    explicit thread_pool_executor(std::size_t threads) : _stop(false)
+    {
+      for (std::size_t i = 0; i < threads; ++i)
+        _threads.emplace_back(&thread_pool_executor::work, this);
+    }
+
+    thread_pool_executor(const thread_pool_executor&) = delete;
+    thread_pool_executor& operator=(const thread_pool_executor&) = delete;
+
+    // runs what is ready, coroutines still suspended are never resumed
+    ~thread_pool_executor()
+    {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+      }
+      _ready_cv.notify_all();
+      for (auto& thread : _threads)
+        thread.join();
+    }
+
+    void post(std::coroutine_handle<> handle)
+    {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _ready.push_back(handle);
+      }
+      _ready_cv.notify_one();
+    }
+  };
+
+  namespace detail {
+    struct null_mutex {
+      void lock() JM_CB_NOEXCEPT {}
+
+      void unlock() JM_CB_NOEXCEPT {}
+    };
+
+    // intrusive FIFO of suspended awaiters, which live in the coroutine frames
+    template<class Awaiter>
+    struct waiter_queue {
+      Awaiter* head = JM_CB_NULLPTR;
+      Awaiter* tail = JM_CB_NULLPTR;
+
+      bool empty() const JM_CB_NOEXCEPT { return head == JM_CB_NULLPTR; }
+
+      void push(Awaiter* awaiter) JM_CB_NOEXCEPT
+      {
+        awaiter->_next = JM_CB_NULLPTR;
+        (tail ? tail->_next : head) = awaiter;
+        tail = awaiter;
+      }
+
+      Awaiter* pop() JM_CB_NOEXCEPT
+      {
+        Awaiter* awaiter = head;
+        head = awaiter->_next;
+        if (head == JM_CB_NULLPTR)
+          tail = JM_CB_NULLPTR;
+        return awaiter;
+      }
+    };
+  } // namespace detail
+
+  // Bounded channel for coroutines. co_await push(x) suspends while the ring is full
+  // and co_await pop() while it is empty; the counterpart operation hands the value
+  // over directly and posts the waiter back to the executor, without any thread hop
+  // or condition variable. Use Mutex = std::mutex when the channel is shared by
+  // coroutines running on several threads.
+  template<typename T, class Executor, class Mutex = detail::null_mutex>
+  class channel {
+  public:
+    typedef T           value_type;
+    typedef std::size_t size_type;
+
+    class push_awaiter;
+    class pop_awaiter;
+
+  private:
+    dynamic_circular_buffer<T>         _items; // at least 2 slots, full() checks _capacity
+    size_type                          _capacity;
+    Executor&                          _executor;
+    Mutex                              _mutex;
+    detail::waiter_queue<push_awaiter> _pushers;
+    detail::waiter_queue<pop_awaiter>  _poppers;
+    bool                               _closed;
+
+    bool full() const JM_CB_NOEXCEPT { return _items.size() == _capacity; }
+
+  public:
+    class push_awaiter {
+      friend class channel;
+      friend struct detail::waiter_queue<push_awaiter>;
+
+      channel&                _channel;
+      T                       _value;
+      bool                    _accepted;
+      std::coroutine_handle<> _handle;
+      push_awaiter*           _next;
+
+    public:
+      push_awaiter(channel& ch, T value) : _channel(ch), _value(std::move(value)), _accepted(false), _next() {}
+
+      bool await_ready() const JM_CB_NOEXCEPT { return false; }
+
+      bool await_suspend(std::coroutine_handle<> handle)
+      {
+        std::lock_guard<Mutex> lock(_channel._mutex);
+        if (_channel._closed)
+          return false;
+
+        _accepted = true;
+        if (!_channel._poppers.empty()) {
+          pop_awaiter* popper = _channel._poppers.pop();
+          popper->_value.emplace(std::move(_value));
+          _channel._executor.post(popper->_handle);
+          return false;
+        }
+        if (!_channel.full()) {
+          _channel._items.push_back(std::move(_value));
+          return false;
+        }
+
+        _accepted = false;
+        _handle = handle;
+        _channel._pushers.push(this);
+        return true;
+      }
+
+      // false if the channel was closed before the value could be delivered
+      bool await_resume() const JM_CB_NOEXCEPT { return _accepted; }
+    };
+
+    class pop_awaiter {
+      friend class channel;
+      friend struct detail::waiter_queue<pop_awaiter>;
+
+      channel&                _channel;
+      std::optional<T>        _value;
+      std::coroutine_handle<> _handle;
+      pop_awaiter*            _next;
+
+    public:
+      explicit pop_awaiter(channel& ch) : _channel(ch), _value(), _next() {}
+
+      bool await_ready() const JM_CB_NOEXCEPT { return false; }
+
+      bool await_suspend(std::coroutine_handle<> handle)
+      {
+        std::lock_guard<Mutex> lock(_channel._mutex);
+        if (!_channel._items.empty()) {
+          _value.emplace(std::move(_channel._items.front()));
+          _channel._items.pop_front();
+
+          // the oldest blocked pusher takes the freed slot
+          if (!_channel._pushers.empty()) {
+            push_awaiter* pusher = _channel._pushers.pop();
+            _channel._items.push_back(std::move(pusher->_value));
+            pusher->_accepted = true;
+            _channel._executor.post(pusher->_handle);
+          }
+          return false;
+        }
+        if (!_channel._pushers.empty()) { // only with a capacity of 0
+          push_awaiter* pusher = _channel._pushers.pop();
+          _value.emplace(std::move(pusher->_value));
+          pusher->_accepted = true;
+          _channel._executor.post(pusher->_handle);
+          return false;
+        }
+        if (_channel._closed)
+          return false;
+
+        _handle = handle;
+        _channel._poppers.push(this);
+        return true;
+      }
+
+      // the oldest value, or nothing once the channel is closed and drained
+      std::optional<T> await_resume() { return std::move(_value); }
+    };
+
+    // a capacity of 0 makes every push wait for a pop
+    channel(Executor& executor, size_type capacity)
+      : _items(std::max<size_type>(capacity, 2)), _capacity(capacity), _executor(executor), _mutex(), _pushers(), _poppers(), _closed(false)
+    {}
+
+    channel(const channel&) = delete;
+    channel& operator=(const channel&) = delete;
+
+    push_awaiter push(T value) { return push_awaiter(*this, std::move(value)); }
+
+    pop_awaiter pop() { return pop_awaiter(*this); }
+
+    // wakes every waiter: pending pushes fail, pops drain what is left then get nothing
+    void close()
+    {
+      std::lock_guard<Mutex> lock(_mutex);
+      _closed = true;
+      while (!_pushers.empty())
+        _executor.post(_pushers.pop()->_handle);
+      while (!_poppers.empty())
+        _executor.post(_poppers.pop()->_handle);
+    }
+
+    size_type capacity() const JM_CB_NOEXCEPT { return _capacity; }
+  };
+} // namespace jm
+
+#endif // JM_CB_HAS_COROUTINES
+
+#endif // JM_COROUTINE_CHANNEL_HPP
@@ -0,0 +1,168 @@
+#ifndef JM_DELAY_LINE_HPP
+#define JM_DELAY_LINE_HPP
+
+#include <circular_buffer/static_circular_buffer.hpp>
+#include <circular_buffer/dynamic_circular_buffer.hpp>
+
+namespace jm {
+  // Interpolators read points p[0], p[1], ... at integer delays floor(d) - offset,
+  // floor(d) - offset + 1, ... and evaluate the signal at the fractional part f of d.
+  struct linear_interpolation {
+    static JM_CB_CONSTEXPR std::size_t points = 2;
+    static JM_CB_CONSTEXPR std::size_t offset = 0;
+
+    template<typename T>
+    static JM_CB_CONSTEXPR T interpolate(const T* p, T f) JM_CB_NOEXCEPT
+    {
+      return p[0] + f * (p[1] - p[0]);
+    }
+  };
+
+  // 4 point, 3rd order Hermite ( Catmull-Rom ) spline
+  struct cubic_interpolation {
+    static JM_CB_CONSTEXPR std::size_t points = 4;
+    static JM_CB_CONSTEXPR std::size_t offset = 1;
+
+    template<typename T>
+    static JM_CB_CONSTEXPR T interpolate(const T* p, T f) JM_CB_NOEXCEPT
+    {
+      const T half = T(1) / T(2);
+      const T c1 = half * (p[2] - p[0]);
+      const T c2 = p[0] - T(5) / T(2) * p[1] + T(2) * p[2] - half * p[3];
+      const T c3 = half * (p[3] - p[0]) + T(3) / T(2) * (p[1] - p[2]);
+      return ((c3 * f + c2) * f + c1) * f + p[1];
+    }
+  };
+
+  // 4 point, 3rd order Lagrange polynomial
+  struct lagrange_interpolation {
+    static JM_CB_CONSTEXPR std::size_t points = 4;
+    static JM_CB_CONSTEXPR std::size_t offset = 1;
+
+    template<typename T>
+    static JM_CB_CONSTEXPR T interpolate(const T* p, T f) JM_CB_NOEXCEPT
+    {
+      const T dm1 = f + T(1);
+      const T d1 = f - T(1);
+      const T d2 = f - T(2);
+      return -f * d1 * d2 / T(6) * p[0] + dm1 * d1 * d2 / T(2) * p[1] -
+             dm1 * f * d2 / T(2) * p[2] + dm1 * f * d1 / T(6) * p[3];
+    }
+  };
+
+  // Delay line with reads at fractional delays, measured in samples back from the
+  // newest one ( delay 0 is back() ). Points outside of the stored history are clamped
+  // to the oldest / newest sample.
+  template<class Buffer, class Interpolation = linear_interpolation>
+  class delay_line {
+  public:
+    typedef Buffer                      buffer_type;
+    typedef typename Buffer::value_type value_type;
+    typedef typename Buffer::size_type  size_type;
+
+  private:
+    static JM_CB_CONSTEXPR size_type points = Interpolation::points;
+    static JM_CB_CONSTEXPR size_type block_size = 64;
+
+    Buffer _samples;
+
+    // sample at integer delay, clamped to the stored history
+    inline const value_type& tap(size_type base, size_type point) const JM_CB_NOEXCEPT
+    {
+      const size_type newest = _samples.size() - 1;
+      size_type       delay = base + point;
+      delay = delay < Interpolation::offset ? 0 : delay - Interpolation::offset;
+      return _samples[newest - std::min(delay, newest)];
+    }
+
+  public:
+    delay_line() : _samples() {}
+
+    /// capacity
+    void reserve(size_type max_delay) { _samples.reserve(max_delay); }
+
+    bool empty() const JM_CB_NOEXCEPT { return _samples.empty(); }
+
+    size_type size() const JM_CB_NOEXCEPT { return _samples.size(); }
+
+    size_type max_size() const JM_CB_NOEXCEPT { return _samples.max_size(); }
+
+    const Buffer& buffer() const JM_CB_NOEXCEPT { return _samples; }
+
+    /// modifiers
+    void push(const value_type& sample) { _samples.push_back(sample); }
+
+    void clear() { _samples.clear(); }
+
+    /// reads
+    value_type read(value_type delay) const JM_CB_NOEXCEPT
+    {
+      JM_ASSERT(!empty(), "There are empty buffer");
+      delay = std::max(delay, value_type(0));
+      const size_type  base = static_cast<size_type>(delay);
+      const value_type frac = delay - static_cast<value_type>(base);
+
+      value_type p[points];
+      for (size_type i = 0; i < points; ++i)
+        p[i] = tap(base, i);
+      return Interpolation::interpolate(p, frac);
+    }
+
+    // out[i] = read(delays[i]). The taps are gathered block-wise into one array per
+    // interpolation point, so the interpolation itself runs vectorized across taps.
+    void read(const value_type* delays, value_type* out, size_type count) const JM_CB_NOEXCEPT
+    {
+      JM_ASSERT(!empty(), "There are empty buffer");
+      const auto      one = _samples.array_one();
+      const auto      two = _samples.array_two();
+      const size_type newest = _samples.size() - 1;
+
+      size_type  base[block_size];
+      value_type frac[block_size];
+      value_type p[points][block_size];
+
+      for (size_type done = 0; done < count; done += block_size) {
+        const size_type n = std::min(block_size, count - done);
+
+        for (size_type j = 0; j < n; ++j) {
+          const value_type delay = std::max(delays[done + j], value_type(0));
+          base[j] = static_cast<size_type>(delay);
+          frac[j] = delay - static_cast<value_type>(base[j]);
+        }
+
+        for (size_type j = 0; j < n; ++j) {
+          // all points of a tap are adjacent in memory unless they are clamped or
+          // straddle the wrap around
+          if (base[j] >= Interpolation::offset && base[j] - Interpolation::offset + points <= size()) {
+            const size_type last = newest - (base[j] - Interpolation::offset);
+            const size_type first = last - (points - 1);
+            if (last < one.second || first >= one.second) {
+              const value_type* src = last < one.second ? one.first + last : two.first + (last - one.second);
+              for (size_type i = 0; i < points; ++i)
+                p[i][j] = *(src - i);
+              continue;
+            }
+          }
+
+          for (size_type i = 0; i < points; ++i)
+            p[i][j] = tap(base[j], i);
+        }
+
+        for (size_type j = 0; j < n; ++j) {
+          value_type column[points];
+          for (size_type i = 0; i < points; ++i)
+            column[i] = p[i][j];
+          out[done + j] = Interpolation::interpolate(column, frac[j]);
+        }
+      }
+    }
+  };
+
+  template<class T, std::size_t N, class Interpolation = linear_interpolation>
+  using static_delay_line = delay_line<static_circular_buffer<T, N>, Interpolation>;
+
+  template<class T, class Interpolation = linear_interpolation, class Allocator = std::allocator<T>>
+  using dynamic_delay_line = delay_line<dynamic_circular_buffer<T, Allocator>, Interpolation>;
+} // namespace jm
+
+#endif // JM_DELAY_LINE_HPP
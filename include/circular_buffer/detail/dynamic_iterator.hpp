@@ -17,6 +17,12 @@ namespace jm {
       {
         return max_value ? (value + max_value - 1) % max_value : 0;
       }
+
+      inline static JM_CB_CONSTEXPR std::size_t advance(std::size_t value, std::size_t n, std::size_t max_value)
+        JM_CB_NOEXCEPT
+      {
+        return value + n >= max_value ? value + n - max_value : value + n;
+      }
     };
 
     // special case when we need dynamic buffer and we can't specify size buffer at compile time
@@ -91,6 +97,9 @@ namespace jm {
         return JM_CB_ADDRESSOF(*(_buf + _pos));
       }
 
+      // number of elements from this one to the end
+      JM_CB_CONSTEXPR std::size_t left_in_forward() const JM_CB_NOEXCEPT { return _left_in_forward; }
+
       JM_CB_CXX14_CONSTEXPR cb_iterator& operator++() JM_CB_NOEXCEPT
       {
         _pos = wrapper_t::increment(_pos, _max_size);
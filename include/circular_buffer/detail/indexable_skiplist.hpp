@@ -0,0 +1,187 @@
+#ifndef JM_INDEXABLE_SKIPLIST_HPP
+#define JM_INDEXABLE_SKIPLIST_HPP
+
+#include <circular_buffer/config.hpp>
+
+#include <cstdint>
+#include <functional>
+
+namespace jm::detail {
+  // Skiplist whose links also store how many elements they jump over, which makes
+  // insert, erase and access by rank O(log n) expected. Nodes live in a pool that is
+  // allocated once by reserve(), so steady state updates never allocate. Every pool
+  // slot gets its level once, up front, and keeps it when it is reused.
+  template<class T, class Compare = std::less<T>>
+  class indexable_skiplist {
+  public:
+    typedef T           value_type;
+    typedef std::size_t size_type;
+
+  private:
+    static JM_CB_CONSTEXPR size_type nil = static_cast<size_type>(-1);
+
+    std::vector<T>         _values;
+    std::vector<size_type> _offset; // first link of node i, the head is the last node
+    std::vector<size_type> _next;
+    std::vector<size_type> _width;
+    std::vector<size_type> _level;
+    std::vector<size_type> _free;
+    size_type              _levels;
+    size_type              _size;
+    Compare                _comp;
+
+    inline size_type head() const JM_CB_NOEXCEPT { return _values.size(); }
+
+    inline size_type& next(size_type node, size_type level) JM_CB_NOEXCEPT { return _next[_offset[node] + level]; }
+
+    inline size_type& width(size_type node, size_type level) JM_CB_NOEXCEPT { return _width[_offset[node] + level]; }
+
+    inline size_type next(size_type node, size_type level) const JM_CB_NOEXCEPT { return _next[_offset[node] + level]; }
+
+    inline size_type width(size_type node, size_type level) const JM_CB_NOEXCEPT { return _width[_offset[node] + level]; }
+
+  public:
+    explicit indexable_skiplist(const Compare& comp = Compare())
+      : _levels(0), _size(0), _comp(comp)
+    {
+      reserve(0);
+    }
+
+    void reserve(size_type capacity)
+    {
+      _levels = 1;
+      while ((size_type(1) << _levels) < capacity)
+        ++_levels;
+
+      _values.assign(capacity, T());
+      _offset.resize(capacity + 1);
+      _level.resize(capacity + 1);
+      _free.reserve(capacity);
+
+      std::uint64_t state = 0x9E3779B97F4A7C15ull;
+      size_type     links = 0;
+      for (size_type i = 0; i < capacity; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        size_type level = 1;
+        for (std::uint64_t bits = state; (bits & 1) && level < _levels; bits >>= 1)
+          ++level;
+
+        _offset[i] = links;
+        _level[i] = level;
+        links += level;
+      }
+      _offset[capacity] = links;
+      _level[capacity] = _levels;
+      links += _levels;
+
+      _next.assign(links, nil);
+      _width.assign(links, 0);
+      clear();
+    }
+
+    void clear() JM_CB_NOEXCEPT
+    {
+      for (size_type level = 0; level < _levels; ++level) {
+        next(head(), level) = nil;
+        width(head(), level) = 1;
+      }
+
+      _free.clear();
+      for (size_type i = _values.size(); i != 0; --i)
+        _free.push_back(i - 1);
+      _size = 0;
+    }
+
+    size_type size() const JM_CB_NOEXCEPT { return _size; }
+
+    size_type max_size() const JM_CB_NOEXCEPT { return _values.size(); }
+
+    void insert(const value_type& value)
+    {
+      JM_ASSERT(!_free.empty(), "skiplist is full");
+      size_type chain[64];
+      size_type steps[64];
+
+      size_type node = head();
+      for (size_type level = _levels; level-- != 0;) {
+        steps[level] = 0;
+        for (size_type n = next(node, level); n != nil && !_comp(value, _values[n]); n = next(node, level)) {
+          steps[level] += width(node, level);
+          node = n;
+        }
+        chain[level] = node;
+      }
+
+      const size_type new_node = _free.back();
+      _free.pop_back();
+      _values[new_node] = value;
+
+      const size_type d = _level[new_node];
+      size_type       skipped = 0;
+      for (size_type level = 0; level < d; ++level) {
+        const size_type prev = chain[level];
+        next(new_node, level) = next(prev, level);
+        next(prev, level) = new_node;
+        width(new_node, level) = width(prev, level) - skipped;
+        width(prev, level) = skipped + 1;
+        skipped += steps[level];
+      }
+
+      for (size_type level = d; level < _levels; ++level)
+        ++width(chain[level], level);
+
+      ++_size;
+    }
+
+    // removes one element equivalent to value, returns false if there is none
+    bool erase(const value_type& value)
+    {
+      size_type chain[64];
+
+      size_type node = head();
+      for (size_type level = _levels; level-- != 0;) {
+        for (size_type n = next(node, level); n != nil && _comp(_values[n], value); n = next(node, level))
+          node = n;
+        chain[level] = node;
+      }
+
+      const size_type victim = next(chain[0], 0);
+      if (victim == nil || _comp(value, _values[victim]))
+        return false;
+
+      const size_type d = _level[victim];
+      for (size_type level = 0; level < d; ++level) {
+        const size_type prev = chain[level];
+        width(prev, level) += width(victim, level) - 1;
+        next(prev, level) = next(victim, level);
+      }
+
+      for (size_type level = d; level < _levels; ++level)
+        --width(chain[level], level);
+
+      _free.push_back(victim);
+      --_size;
+      return true;
+    }
+
+    // k-th smallest element, 0 based
+    const value_type& operator[](size_type k) const JM_CB_NOEXCEPT
+    {
+      JM_ASSERT(k < _size, "rank out of range");
+      size_type node = head();
+      ++k;
+      for (size_type level = _levels; level-- != 0;) {
+        while (next(node, level) != nil && width(node, level) <= k) {
+          k -= width(node, level);
+          node = next(node, level);
+        }
+      }
+      return _values[node];
+    }
+  };
+} // namespace jm::detail
+
+#endif // JM_INDEXABLE_SKIPLIST_HPP
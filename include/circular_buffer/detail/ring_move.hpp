@@ -0,0 +1,84 @@
+#ifndef JM_RING_MOVE_HPP
+#define JM_RING_MOVE_HPP
+
+#include <circular_buffer/config.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace jm {
+  namespace detail {
+    template<class T>
+    JM_CB_CONSTEXPR T& slot_value(T& value) JM_CB_NOEXCEPT
+    {
+      return value;
+    }
+
+    template<class T, bool TriviallyDestructible>
+    JM_CB_CONSTEXPR T& slot_value(optional_storage<T, TriviallyDestructible>& slot) JM_CB_NOEXCEPT
+    {
+      return slot._value;
+    }
+
+    // Moves count live elements of the ring held by slots from physical index src to
+    // dst. Elements are moved in ascending order when the range moves toward the head
+    // and in descending order otherwise, so overlapping ranges are safe. Outside of
+    // constant evaluation trivially copyable elements are moved with one memmove per
+    // piece that wraps in neither range, at most three of them.
+    template<class Slots>
+    JM_CB_CXX20_CONSTEXPR void ring_move(Slots& slots, std::size_t src, std::size_t dst, std::size_t count,
+                                         bool toward_head)
+    {
+      typedef typename std::remove_reference<decltype(slot_value(slots[0]))>::type T;
+      const std::size_t capacity = slots.size();
+      if (count == 0)
+        return;
+
+      if constexpr (std::is_trivially_copyable<T>::value) {
+        if (!JM_CB_IS_CONSTANT_EVALUATED()) {
+          T* const base = JM_CB_ADDRESSOF(slot_value(slots[0]));
+          if (toward_head) {
+            while (count != 0) {
+              const std::size_t n = std::min({ count, capacity - src, capacity - dst });
+              std::memmove(base + dst, base + src, n * sizeof(T));
+              src = src + n == capacity ? 0 : src + n;
+              dst = dst + n == capacity ? 0 : dst + n;
+              count -= n;
+            }
+          }
+          else {
+            // one past the last element of each range
+            std::size_t src_end = src + count > capacity ? src + count - capacity : src + count;
+            std::size_t dst_end = dst + count > capacity ? dst + count - capacity : dst + count;
+            while (count != 0) {
+              if (src_end == 0)
+                src_end = capacity;
+              if (dst_end == 0)
+                dst_end = capacity;
+              const std::size_t n = std::min({ count, src_end, dst_end });
+              std::memmove(base + dst_end - n, base + src_end - n, n * sizeof(T));
+              src_end -= n;
+              dst_end -= n;
+              count -= n;
+            }
+          }
+          return;
+        }
+      }
+
+      const auto at = [capacity](std::size_t position, std::size_t i) {
+        return position + i >= capacity ? position + i - capacity : position + i;
+      };
+      if (toward_head)
+        for (std::size_t i = 0; i < count; ++i)
+          slot_value(slots[at(dst, i)]) = std::move(slot_value(slots[at(src, i)]));
+      else
+        for (std::size_t i = count; i-- != 0;)
+          slot_value(slots[at(dst, i)]) = std::move(slot_value(slots[at(src, i)]));
+    }
+  } // namespace detail
+} // namespace jm
+
+#endif // JM_RING_MOVE_HPP
@@ -20,6 +20,13 @@ namespace jm {
       {
         return (value + N - 1) % N;
       }
+
+      // value + n for n < N, without a division
+      inline static JM_CB_CONSTEXPR size_type advance(size_type value, size_type n)
+        JM_CB_NOEXCEPT
+      {
+        return value + n >= N ? value + n - N : value + n;
+      }
     };
 
     template<class S, class TC, std::size_t N>
@@ -85,6 +92,9 @@ namespace jm {
         return JM_CB_ADDRESSOF((_buf + _pos)->_value);
       }
 
+      // number of elements from this one to the end
+      JM_CB_CONSTEXPR std::size_t left_in_forward() const JM_CB_NOEXCEPT { return _left_in_forward; }
+
       JM_CB_CXX14_CONSTEXPR cb_iterator& operator++() JM_CB_NOEXCEPT
       {
         _pos = wrapper_t::increment(_pos);
@@ -2,12 +2,20 @@
 #define JM_DYNAMIC_CIRCULAR_BUFFER_HPP
 
 #include <circular_buffer/detail/dynamic_iterator.hpp>
+#include <circular_buffer/detail/ring_move.hpp>
+#include <circular_buffer/buffer_stats.hpp>
+#include <circular_buffer/overflow.hpp>
+
+#include <limits>
 
 namespace jm
 {
 
-  template <typename T, class Allocator = std::allocator<T>>
-  class dynamic_circular_buffer
+  // Overflow is one of the jm::overflow policies, Stats is null_buffer_stats or
+  // buffer_stats
+  template <typename T, class Allocator = std::allocator<T>, class Overflow = overflow::overwrite,
+            class Stats = null_buffer_stats>
+  class dynamic_circular_buffer : private Stats
   {
   public:
     typedef std::vector<T, Allocator>                container;
@@ -22,9 +30,13 @@ namespace jm
     typedef detail::cb_iterator<const T, const T, 0> const_iterator;
     typedef std::reverse_iterator<iterator>          reverse_iterator;
     typedef std::reverse_iterator<const_iterator>    const_reverse_iterator;
+    typedef std::pair<pointer, size_type>            array_range;
+    typedef std::pair<const_pointer, size_type>      const_array_range;
+    typedef Overflow                                 overflow_policy;
 
   private:
     typedef detail::cb_index_wrapper<size_type, 0> wrapper_t;
+    typedef detail::overflow_traits<Overflow>      overflow_traits;
 
     size_type _head;
     size_type _tail;
@@ -35,6 +47,21 @@ namespace jm
     { /*_buffer[idx].~T();*/
     }
 
+    inline iterator iterator_at(size_type k) JM_CB_NOEXCEPT
+    {
+      return k == _size ? end()
+                        : iterator(_buffer.data(), wrapper_t::advance(_head, k, _buffer.size()), _size - k, _buffer.size());
+    }
+
+    // pops the elements consumed so far when it goes out of scope, even by an exception
+    struct consume_guard
+    {
+      dynamic_circular_buffer& buffer;
+      size_type                count;
+
+      ~consume_guard() { buffer.erase_begin(count); }
+    };
+
     inline void copy_buffer(const dynamic_circular_buffer& other)
     {
       const_iterator       first = other.cbegin();
@@ -55,6 +82,39 @@ namespace jm
         emplace_back(std::move(*first));
     }
 
+    // moves the elements, oldest first, to a storage twice as large and puts the new
+    // one after them or in its last slot. it is built before the old storage goes, in
+    // case args refer to an element
+    template <typename... Args>
+    void grow_emplace(bool at_back, Args&&... args)
+    {
+      const size_type capacity = _buffer.size();
+      container       grown(capacity != 0 ? 2 * capacity : 2, _buffer.get_allocator());
+      const size_type slot = at_back ? _size : grown.size() - 1;
+
+      grown[slot] = value_type(std::forward<Args>(args)...);
+      for (size_type i = 0; i < _size; ++i)
+        grown[i] = std::move_if_noexcept(_buffer[wrapper_t::advance(_head, i, capacity)]);
+      _buffer.swap(grown);
+
+      _head = at_back ? 0 : slot;
+      _tail = at_back || _size == 0 ? slot : _size - 1;
+      ++_size;
+      Stats::on_push(1, _size, _buffer.size());
+    }
+
+    // moves the elements, oldest first, to the start of a storage of capacity slots
+    void relocate(size_type capacity)
+    {
+      container relocated(capacity, _buffer.get_allocator());
+      for (size_type i = 0; i < _size; ++i)
+        relocated[i] = std::move_if_noexcept(_buffer[wrapper_t::advance(_head, i, _buffer.size())]);
+      _buffer.swap(relocated);
+
+      _head = _size != 0 ? 0 : 1;
+      _tail = _size != 0 ? _size - 1 : 0;
+    }
+
   public:
     JM_CB_CONSTEXPR explicit dynamic_circular_buffer() : _head(1), _tail(0), _size(0), _buffer() {}
 
@@ -140,21 +200,25 @@ namespace jm
     /// capacity
     JM_CB_CONSTEXPR void reserve(size_type new_cap)
     {
+      Stats::on_pop(_size);
       _size = 0;
       _head = 1;
       _tail = 0;
 
       _buffer.resize(new_cap);
+      Stats::on_push(0, _size, _buffer.size());
     }
 
     JM_CB_CONSTEXPR void resize(size_type new_size)
     {
+      Stats::on_pop(_size - std::min(_size, new_size));
       _size = std::min(_size, new_size);
 
       _head = _size ? 0 : 1;
       _tail = _size ? _size - 1 : 0;
 
       _buffer.resize(new_size);
+      Stats::on_push(0, _size, _buffer.size());
     }
     JM_CB_CONSTEXPR size_type capacity() const JM_CB_NOEXCEPT { return _buffer.size(); }
 
@@ -166,6 +230,8 @@ namespace jm
 
     JM_CB_CONSTEXPR size_type max_size() const JM_CB_NOEXCEPT { return _buffer.size(); }
 
+    JM_CB_CONSTEXPR const Stats& stats() const JM_CB_NOEXCEPT { return *this; }
+
     /// element access
     JM_CB_CXX14_CONSTEXPR reference front() JM_CB_NOEXCEPT {
         JM_ASSERT(!empty(), "There are empty buffer"); 
@@ -187,6 +253,33 @@ namespace jm
         return _buffer[_tail]; 
     }
 
+    // i-th element counting from front()
+    JM_CB_CXX14_CONSTEXPR reference operator[](size_type i) JM_CB_NOEXCEPT
+    {
+      JM_ASSERT(i < _size, "index out of range");
+      return _buffer[wrapper_t::advance(_head, i, _buffer.size())];
+    }
+
+    JM_CB_CXX14_CONSTEXPR const_reference operator[](size_type i) const JM_CB_NOEXCEPT
+    {
+      JM_ASSERT(i < _size, "index out of range");
+      return _buffer[wrapper_t::advance(_head, i, _buffer.size())];
+    }
+
+    JM_CB_CXX14_CONSTEXPR reference at(size_type i)
+    {
+      if (JM_CB_UNLIKELY(i >= _size))
+        throw std::out_of_range("dynamic_circular_buffer<T>::at(size_type) index out of range");
+      return _buffer[wrapper_t::advance(_head, i, _buffer.size())];
+    }
+
+    JM_CB_CXX14_CONSTEXPR const_reference at(size_type i) const
+    {
+      if (JM_CB_UNLIKELY(i >= _size))
+        throw std::out_of_range("dynamic_circular_buffer<T>::at(size_type) index out of range");
+      return _buffer[wrapper_t::advance(_head, i, _buffer.size())];
+    }
+
     JM_CB_CXX14_CONSTEXPR pointer data() JM_CB_NOEXCEPT {
         JM_ASSERT(!empty(), "There are empty buffer"); 
         return JM_CB_ADDRESSOF(_buffer[0]);
@@ -197,12 +290,63 @@ namespace jm
         return JM_CB_ADDRESSOF(_buffer[0]);
     }
 
+    /// contiguous segments, array_one() holds the oldest elements
+    JM_CB_CXX14_CONSTEXPR array_range array_one() JM_CB_NOEXCEPT
+    {
+      if (_size == 0)
+        return array_range(_buffer.data(), 0);
+      return array_range(_buffer.data() + _head, std::min(_size, _buffer.size() - _head));
+    }
+
+    JM_CB_CXX14_CONSTEXPR const_array_range array_one() const JM_CB_NOEXCEPT
+    {
+      if (_size == 0)
+        return const_array_range(_buffer.data(), 0);
+      return const_array_range(_buffer.data() + _head, std::min(_size, _buffer.size() - _head));
+    }
+
+    JM_CB_CXX14_CONSTEXPR array_range array_two() JM_CB_NOEXCEPT
+    {
+      return array_range(_buffer.data(), _size - array_one().second);
+    }
+
+    JM_CB_CXX14_CONSTEXPR const_array_range array_two() const JM_CB_NOEXCEPT
+    {
+      return const_array_range(_buffer.data(), _size - array_one().second);
+    }
+
+    /// free space after back(), written in place and published with commit_back()
+    JM_CB_CXX14_CONSTEXPR array_range free_array_one() JM_CB_NOEXCEPT
+    {
+      const size_type first = wrapper_t::increment(_tail, _buffer.size());
+      return array_range(_buffer.data() + first, std::min(_buffer.size() - _size, _buffer.size() - first));
+    }
+
+    JM_CB_CXX14_CONSTEXPR array_range free_array_two() JM_CB_NOEXCEPT
+    {
+      return array_range(_buffer.data() + 0, _buffer.size() - _size - free_array_one().second);
+    }
+
     /// modifiers
-    void push_back(const value_type& value)
+    // push_* and emplace_* return false only when the buffer is full and Overflow is
+    // overflow::reject
+    bool push_back(const value_type& value)
     {
       size_type new_tail;
       if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == _buffer.size()))
       {
+        if constexpr (overflow_traits::grows)
+        {
+          grow_emplace(true, value);
+          return true;
+        }
+        else if constexpr (!overflow_traits::overwrites)
+        {
+          Stats::on_drop();
+          return overflow_traits::refuse("dynamic_circular_buffer<T>::push_back buffer is full");
+        }
+        Stats::on_overwrite();
+
         new_tail = _head;
         _head    = wrapper_t::increment(_head, _buffer.size());
         --_size;
@@ -217,13 +361,27 @@ namespace jm
 
       _tail = new_tail;
       ++_size;
+      Stats::on_push(1, _size, _buffer.size());
+      return true;
     }
 
-    void push_front(const value_type& value)
+    bool push_front(const value_type& value)
     {
       size_type new_head = 0;
       if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == _buffer.size()))
       {
+        if constexpr (overflow_traits::grows)
+        {
+          grow_emplace(false, value);
+          return true;
+        }
+        else if constexpr (!overflow_traits::overwrites)
+        {
+          Stats::on_drop();
+          return overflow_traits::refuse("dynamic_circular_buffer<T>::push_front buffer is full");
+        }
+        Stats::on_overwrite();
+
         new_head = _tail;
         _tail    = wrapper_t::decrement(_tail, _buffer.size());
         --_size;
@@ -238,13 +396,27 @@ namespace jm
 
       _head = new_head;
       ++_size;
+      Stats::on_push(1, _size, _buffer.size());
+      return true;
     }
 
-    void push_back(value_type&& value)
+    bool push_back(value_type&& value)
     {
       size_type new_tail;
       if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == _buffer.size()))
       {
+        if constexpr (overflow_traits::grows)
+        {
+          grow_emplace(true, std::move(value));
+          return true;
+        }
+        else if constexpr (!overflow_traits::overwrites)
+        {
+          Stats::on_drop();
+          return overflow_traits::refuse("dynamic_circular_buffer<T>::push_back buffer is full");
+        }
+        Stats::on_overwrite();
+
         new_tail = _head;
         _head    = wrapper_t::increment(_head, _buffer.size());
         --_size;
@@ -260,13 +432,27 @@ namespace jm
 
       _tail = new_tail;
       ++_size;
+      Stats::on_push(1, _size, _buffer.size());
+      return true;
     }
 
-    void push_front(value_type&& value)
+    bool push_front(value_type&& value)
     {
       size_type new_head = 0;
       if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == _buffer.size()))
       {
+        if constexpr (overflow_traits::grows)
+        {
+          grow_emplace(false, std::move(value));
+          return true;
+        }
+        else if constexpr (!overflow_traits::overwrites)
+        {
+          Stats::on_drop();
+          return overflow_traits::refuse("dynamic_circular_buffer<T>::push_front buffer is full");
+        }
+        Stats::on_overwrite();
+
         new_head = _tail;
         _tail    = wrapper_t::decrement(_tail, _buffer.size());
         --_size;
@@ -282,14 +468,28 @@ namespace jm
 
       _head = new_head;
       ++_size;
+      Stats::on_push(1, _size, _buffer.size());
+      return true;
     }
 
     template <typename... Args>
-    void emplace_back(Args&&... args)
+    bool emplace_back(Args&&... args)
     {
       size_type new_tail;
       if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == _buffer.size()))
       {
+        if constexpr (overflow_traits::grows)
+        {
+          grow_emplace(true, std::forward<Args>(args)...);
+          return true;
+        }
+        else if constexpr (!overflow_traits::overwrites)
+        {
+          Stats::on_drop();
+          return overflow_traits::refuse("dynamic_circular_buffer<T>::emplace_back buffer is full");
+        }
+        Stats::on_overwrite();
+
         new_tail = _head;
         _head    = wrapper_t::increment(_head, _buffer.size());
         --_size;
@@ -303,14 +503,28 @@ namespace jm
       //  value_type(std::forward<Args>(args)...);
       _tail = new_tail;
       ++_size;
+      Stats::on_push(1, _size, _buffer.size());
+      return true;
     }
 
     template <typename... Args>
-    void emplace_front(Args&&... args)
+    bool emplace_front(Args&&... args)
     {
       size_type new_head;
       if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == _buffer.size()))
       {
+        if constexpr (overflow_traits::grows)
+        {
+          grow_emplace(false, std::forward<Args>(args)...);
+          return true;
+        }
+        else if constexpr (!overflow_traits::overwrites)
+        {
+          Stats::on_drop();
+          return overflow_traits::refuse("dynamic_circular_buffer<T>::emplace_front buffer is full");
+        }
+        Stats::on_overwrite();
+
         new_head = _tail;
         _tail    = wrapper_t::decrement(_tail, _buffer.size());
         --_size;
@@ -323,6 +537,53 @@ namespace jm
       // value_type(std::forward<Args>(args)...);
       _head = new_head;
       ++_size;
+      Stats::on_push(1, _size, _buffer.size());
+      return true;
+    }
+
+    // Appends a slot and returns its object for the caller to overwrite, keeping the
+    // allocations of what it held: the evicted oldest element when the buffer is full,
+    // otherwise whatever the slot held last ( a popped element or a value initialized
+    // T ).
+    reference recycle_back()
+    {
+      static_assert(overflow_traits::overwrites, "recycling replaces the oldest element");
+      size_type new_tail;
+      if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == _buffer.size()))
+      {
+        Stats::on_overwrite();
+        new_tail = _head;
+        _head    = wrapper_t::increment(_head, _buffer.size());
+        --_size;
+      }
+      else
+        new_tail = wrapper_t::increment(_tail, _buffer.size());
+
+      _tail = new_tail;
+      ++_size;
+      Stats::on_push(1, _size, _buffer.size());
+      return _buffer[new_tail];
+    }
+
+    // recycle_back() at the front, evicting the newest element when full
+    reference recycle_front()
+    {
+      static_assert(overflow_traits::overwrites, "recycling replaces the oldest element");
+      size_type new_head;
+      if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == _buffer.size()))
+      {
+        Stats::on_overwrite();
+        new_head = _tail;
+        _tail    = wrapper_t::decrement(_tail, _buffer.size());
+        --_size;
+      }
+      else
+        new_head = wrapper_t::decrement(_head, _buffer.size());
+
+      _head = new_head;
+      ++_size;
+      Stats::on_push(1, _size, _buffer.size());
+      return _buffer[new_head];
     }
 
     JM_CB_CXX14_CONSTEXPR void pop_back() JM_CB_NOEXCEPT
@@ -332,6 +593,7 @@ namespace jm
       --_size;
       _tail = wrapper_t::decrement(_tail, _buffer.size());
       destroy(old_tail);
+      Stats::on_pop(1);
     }
 
     JM_CB_CXX14_CONSTEXPR void pop_front() JM_CB_NOEXCEPT
@@ -341,10 +603,228 @@ namespace jm
       --_size;
       _head = wrapper_t::increment(_head, _buffer.size());
       destroy(old_head);
+      Stats::on_pop(1);
+    }
+
+    // appends the first n free slots, written through free_array_one() / free_array_two()
+    JM_CB_CXX14_CONSTEXPR void commit_back(size_type n) JM_CB_NOEXCEPT
+    {
+      JM_ASSERT(n <= _buffer.size() - _size, "commit exceeds the free space");
+      if (n == 0)
+        return;
+      _tail = wrapper_t::advance(_tail, n, _buffer.size());
+      _size += n;
+      Stats::on_push(n, _size, _buffer.size());
+    }
+
+    // Appends gen(0), ..., gen(n - 1), assigned in place one free segment at a time.
+    // When they do not fit, the overflow policy applies to the whole batch: the oldest
+    // elements are overwritten ( and only the last max_size() are generated ), those
+    // that do not fit are rejected, std::length_error is thrown before anything
+    // changes, or the capacity grows to fit them. Returns the number of elements
+    // appended.
+    template <typename Generator>
+    size_type generate_back(size_type n, Generator gen)
+    {
+      size_type first = 0;
+      if (JM_CB_UNLIKELY(n > _buffer.size() - _size))
+      {
+        if constexpr (overflow_traits::grows)
+          relocate(std::max({ 2 * _buffer.size(), _size + n, size_type(2) }));
+        else if constexpr (overflow_traits::overwrites)
+        {
+          if (n > _buffer.size())
+            first = n - _buffer.size();
+          const size_type evicted = n - first - (_buffer.size() - _size);
+          for (size_type i = 0; i < evicted; ++i)
+            Stats::on_overwrite();
+          _head = wrapper_t::advance(_head, evicted, _buffer.size());
+          _size -= evicted;
+        }
+        else
+        {
+          for (size_type i = _buffer.size() - _size; i < n; ++i)
+            Stats::on_drop();
+          overflow_traits::refuse("dynamic_circular_buffer<T>::generate_back buffer is full");
+          n = _buffer.size() - _size;
+        }
+      }
+
+      const size_type count = n - first;
+      if (count == 0)
+        return 0;
+
+      const array_range one    = free_array_one();
+      const size_type   in_one = std::min(count, one.second);
+      pointer           dest   = one.first;
+      for (size_type i = 0; i < in_one; ++i)
+        dest[i] = gen(first + i);
+
+      dest = _buffer.data();
+      for (size_type i = in_one; i < count; ++i)
+        dest[i - in_one] = gen(first + i);
+
+      _tail = wrapper_t::advance(_tail, count, _buffer.size());
+      _size += count;
+      Stats::on_push(count, _size, _buffer.size());
+      return count;
+    }
+
+    // pops the n oldest elements
+    JM_CB_CXX14_CONSTEXPR void erase_begin(size_type n) JM_CB_NOEXCEPT
+    {
+      JM_ASSERT(n <= _size, "erase exceeds the size");
+      _head = wrapper_t::advance(_head, n, _buffer.size());
+      _size -= n;
+      Stats::on_pop(n);
+    }
+
+    // Calls f(element) in place on up to max of the oldest elements, one contiguous
+    // segment after the other, then pops them together with erase_begin(). Elements f
+    // returned from are popped even when a later call throws. Returns the number of
+    // elements consumed.
+    template <typename F>
+    size_type consume(F f, size_type max = std::numeric_limits<size_type>::max())
+    {
+      consume_guard     guard{ *this, 0 };
+      const array_range segments[2] = { array_one(), array_two() };
+      for (const array_range& segment : segments)
+      {
+        const size_type n = std::min(segment.second, max - guard.count);
+        for (size_type i = 0; i < n; ++i)
+        {
+          f(segment.first[i]);
+          ++guard.count;
+        }
+      }
+      return guard.count;
+    }
+
+    // Calls f(pointer, size_type) on each non empty contiguous segment, oldest first,
+    // then pops everything. Returns the number of elements consumed.
+    template <typename F>
+    size_type consume_segments(F f)
+    {
+      consume_guard     guard{ *this, 0 };
+      const array_range segments[2] = { array_one(), array_two() };
+      for (const array_range& segment : segments)
+        if (segment.second != 0)
+        {
+          f(segment.first, segment.second);
+          guard.count += segment.second;
+        }
+      return guard.count;
+    }
+
+    // Inserts before pos by shifting the shorter side, the elements before pos toward
+    // the head or those after it toward the tail, so at most min(k, size() - k)
+    // elements move for pos at index k, segment-wise with memmove when T is trivially
+    // copyable. When full the overflow policy applies: overwrite evicts the oldest
+    // element, or the new one when it would be the oldest. Returns an iterator to the
+    // new element, end() when it was rejected.
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args)
+    {
+      size_type k = _size - pos.left_in_forward();
+      // built first, args may refer to an element that is about to move
+      value_type value(std::forward<Args>(args)...);
+      if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == _buffer.size()))
+      {
+        if constexpr (overflow_traits::grows)
+          relocate(std::max(2 * _buffer.size(), size_type(2)));
+        else if constexpr (!overflow_traits::overwrites)
+        {
+          Stats::on_drop();
+          overflow_traits::refuse("dynamic_circular_buffer<T>::emplace buffer is full");
+          return end();
+        }
+        else
+        {
+          Stats::on_overwrite();
+          if (k == 0)
+            return begin();
+          _head = wrapper_t::increment(_head, _buffer.size());
+          --_size;
+          --k;
+        }
+      }
+
+      const size_type capacity = _buffer.size();
+      const pointer   base     = _buffer.data();
+      if (k < _size - k)
+      {
+        const size_type new_head = wrapper_t::decrement(_head, capacity);
+        if (k == 0)
+          base[new_head] = std::move(value);
+        else
+        {
+          base[new_head] = std::move(base[_head]);
+          detail::ring_move(_buffer, wrapper_t::increment(_head, capacity), _head, k - 1, true);
+          base[wrapper_t::advance(_head, k - 1, capacity)] = std::move(value);
+        }
+        _head = new_head;
+      }
+      else
+      {
+        const size_type new_tail = wrapper_t::increment(_tail, capacity);
+        if (k == _size)
+          base[new_tail] = std::move(value);
+        else
+        {
+          base[new_tail] = std::move(base[_tail]);
+          detail::ring_move(_buffer, wrapper_t::advance(_head, k, capacity),
+                            wrapper_t::advance(_head, k + 1, capacity), _size - 1 - k, false);
+          base[wrapper_t::advance(_head, k, capacity)] = std::move(value);
+        }
+        _tail = new_tail;
+      }
+
+      ++_size;
+      Stats::on_push(1, _size, capacity);
+      return iterator_at(k);
+    }
+
+    iterator insert(const_iterator pos, const value_type& value) { return emplace(pos, value); }
+
+    iterator insert(const_iterator pos, value_type&& value) { return emplace(pos, std::move(value)); }
+
+    // Erases [first, last) by shifting the shorter side over the gap, at most
+    // min(k, size() - k - m) elements for m elements erased at index k. Returns an
+    // iterator to the element that followed the erased ones.
+    iterator erase(const_iterator first, const_iterator last)
+    {
+      const size_type k = _size - first.left_in_forward();
+      const size_type m = first.left_in_forward() - last.left_in_forward();
+      if (m == 0)
+        return iterator_at(k);
+
+      const size_type capacity = _buffer.size();
+      if (k < _size - k - m)
+      {
+        detail::ring_move(_buffer, _head, wrapper_t::advance(_head, m, capacity), k, false);
+        _head = wrapper_t::advance(_head, m, capacity);
+      }
+      else
+      {
+        detail::ring_move(_buffer, wrapper_t::advance(_head, k + m, capacity),
+                          wrapper_t::advance(_head, k, capacity), _size - k - m, true);
+        _tail = wrapper_t::advance(_tail, capacity - m, capacity);
+      }
+
+      _size -= m;
+      Stats::on_pop(m);
+      return iterator_at(k);
+    }
+
+    iterator erase(const_iterator pos)
+    {
+      const_iterator next = pos;
+      return erase(pos, ++next);
     }
 
     JM_CB_CXX14_CONSTEXPR void clear() JM_CB_NOEXCEPT
     {
+      Stats::on_pop(_size);
       _size = 0;
       _head = 1;
       _tail = 0;
@@ -0,0 +1,201 @@
+#ifndef JM_EVENTFD_NOTIFIER_HPP
+#define JM_EVENTFD_NOTIFIER_HPP
+
+// Linux only, not included by circular_buffer.hpp
+
+#include <circular_buffer/byte_record_ring.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <system_error>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace jm {
+  // Notifier for basic_byte_record_ring<true, eventfd_notifier> that lets an event loop
+  // wait on the ring. readable_fd() becomes readable once high_watermark records are
+  // unread, or max_delay after the ring stopped being empty, whichever comes first.
+  // writable_fd() becomes readable once a producer that found the ring full can
+  // write again, that is when at most low_watermark records are left.
+  //
+  // Signals are coalesced: a batch of records costs the producer one eventfd write
+  // ( or one timer arming ) and the consumer one ack_readable(), instead of one
+  // syscall per record. The consumer calls ack_readable() when woken and then reads
+  // until the ring is empty; records left behind are only signalled again by the
+  // next commit.
+  class eventfd_notifier {
+  public:
+    typedef std::size_t size_type;
+
+  private:
+    int                      _readable; // edge triggered epoll over _read_event and _timer
+    int                      _read_event;
+    int                      _timer;
+    int                      _writable;
+    size_type                _high_watermark;
+    size_type                _low_watermark;
+    std::chrono::nanoseconds _max_delay;
+
+    // records committed by the producer and released by the consumer
+    alignas(64) std::atomic<size_type> _committed;
+    std::atomic<bool>                  _read_signaled;
+    std::atomic<bool>                  _timer_armed;
+    size_type                          _producer_syscalls;
+    alignas(64) std::atomic<size_type> _released;
+    std::atomic<bool>                  _want_writable;
+    size_type                          _consumer_syscalls;
+
+    static int check(int fd, const char* what)
+    {
+      if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), what);
+      return fd;
+    }
+
+    static void signal(int fd) JM_CB_NOEXCEPT
+    {
+      const std::uint64_t one = 1;
+      while (::write(fd, &one, sizeof(one)) < 0 && errno == EINTR) {}
+    }
+
+    void arm_timer() JM_CB_NOEXCEPT
+    {
+      itimerspec spec = {};
+      spec.it_value.tv_sec = static_cast<time_t>(_max_delay.count() / 1000000000);
+      spec.it_value.tv_nsec = static_cast<long>(_max_delay.count() % 1000000000);
+      if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+        spec.it_value.tv_nsec = 1; // zero would disarm it
+      ::timerfd_settime(_timer, 0, &spec, JM_CB_NULLPTR);
+    }
+
+    size_type pending() const JM_CB_NOEXCEPT
+    {
+      return _committed.load(std::memory_order_relaxed) - _released.load(std::memory_order_relaxed);
+    }
+
+    void close_all() JM_CB_NOEXCEPT
+    {
+      for (int fd : { _readable, _read_event, _timer, _writable })
+        if (fd >= 0)
+          ::close(fd);
+    }
+
+  public:
+    explicit eventfd_notifier(size_type                high_watermark = 64,
+                              std::chrono::nanoseconds max_delay = std::chrono::milliseconds(1),
+                              size_type                low_watermark = 0)
+      : _readable(-1), _read_event(-1), _timer(-1), _writable(-1),
+        _high_watermark(std::max<size_type>(high_watermark, 1)), _low_watermark(low_watermark),
+        _max_delay(max_delay), _committed(0), _read_signaled(false), _timer_armed(false),
+        _producer_syscalls(0), _released(0), _want_writable(false), _consumer_syscalls(0)
+    {
+      try {
+        _read_event = check(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC), "eventfd failed");
+        _writable = check(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC), "eventfd failed");
+        _timer = check(::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC), "timerfd_create failed");
+        _readable = check(::epoll_create1(EPOLL_CLOEXEC), "epoll_create1 failed");
+
+        for (int fd : { _read_event, _timer }) {
+          epoll_event event = {};
+          event.events = EPOLLIN | EPOLLET;
+          event.data.fd = fd;
+          check(::epoll_ctl(_readable, EPOLL_CTL_ADD, fd, &event), "epoll_ctl failed");
+        }
+      }
+      catch (...) {
+        close_all();
+        throw;
+      }
+    }
+
+    eventfd_notifier(const eventfd_notifier&) = delete;
+    eventfd_notifier& operator=(const eventfd_notifier&) = delete;
+
+    ~eventfd_notifier() { close_all(); }
+
+    // poll / epoll for reading on these, never read from them directly
+    int readable_fd() const JM_CB_NOEXCEPT { return _readable; }
+
+    int writable_fd() const JM_CB_NOEXCEPT { return _writable; }
+
+    // consumer: clears the readable signal, to be called before draining the ring
+    void ack_readable() JM_CB_NOEXCEPT
+    {
+      _read_signaled.exchange(false);
+      _timer_armed.exchange(false);
+
+      // harvesting the edge triggered events is what resets readable_fd()
+      epoll_event events[2];
+      ::epoll_wait(_readable, events, 2, 0);
+      ++_consumer_syscalls;
+    }
+
+    // producer: clears the writable signal, to be called before writing again
+    void ack_writable() JM_CB_NOEXCEPT
+    {
+      std::uint64_t count;
+      ::read(_writable, &count, sizeof(count));
+      ++_producer_syscalls;
+    }
+
+    // syscalls made by the notifier on both sides, waits excluded. only exact once
+    // both sides are idle
+    size_type syscalls() const JM_CB_NOEXCEPT { return _producer_syscalls + _consumer_syscalls; }
+
+    /// ring hooks
+    void on_commit() JM_CB_NOEXCEPT
+    {
+      _committed.store(_committed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      // orders the published record before reading the flags cleared by ack_readable
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (_read_signaled.load(std::memory_order_relaxed))
+        return;
+
+      if (pending() >= _high_watermark) {
+        if (!_read_signaled.exchange(true)) {
+          signal(_read_event);
+          ++_producer_syscalls;
+        }
+      }
+      else if (!_timer_armed.load(std::memory_order_relaxed) && !_timer_armed.exchange(true)) {
+        arm_timer();
+        ++_producer_syscalls;
+      }
+    }
+
+    void on_release(size_type records) JM_CB_NOEXCEPT
+    {
+      _released.store(_released.load(std::memory_order_relaxed) + records, std::memory_order_relaxed);
+      // orders the freed space before reading the flag set by on_full
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (_want_writable.load(std::memory_order_relaxed) && pending() <= _low_watermark &&
+          _want_writable.exchange(false)) {
+        signal(_writable);
+        ++_consumer_syscalls;
+      }
+    }
+
+    void on_full() JM_CB_NOEXCEPT
+    {
+      if (_want_writable.exchange(true))
+        return;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      // the consumer may have drained the ring before seeing the flag
+      if (pending() <= _low_watermark && _want_writable.exchange(false)) {
+        signal(_writable);
+        ++_producer_syscalls;
+      }
+    }
+  };
+
+  typedef basic_byte_record_ring<true, eventfd_notifier> notifying_byte_record_ring;
+} // namespace jm
+
+#endif // JM_EVENTFD_NOTIFIER_HPP
@@ -0,0 +1,164 @@
+#ifndef JM_FD_IO_HPP
+#define JM_FD_IO_HPP
+
+// POSIX only, not included by circular_buffer.hpp
+
+#include <circular_buffer/snapshot.hpp>
+
+#include <cerrno>
+#include <system_error>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace jm {
+  namespace detail {
+    template<class Range>
+    inline int to_iovec(iovec* iov, const Range& one, const Range& two) JM_CB_NOEXCEPT
+    {
+      iov[0].iov_base = const_cast<void*>(static_cast<const void*>(one.first));
+      iov[0].iov_len = one.second;
+      iov[1].iov_base = const_cast<void*>(static_cast<const void*>(two.first));
+      iov[1].iov_len = two.second;
+      return two.second != 0 ? 2 : 1;
+    }
+
+    // readv / writev until every iovec is transferred, false on end of file
+    template<class Transfer>
+    inline bool transfer_all(Transfer transfer, iovec* iov, int count, const char* what)
+    {
+      for (;;) {
+        for (; count != 0 && iov->iov_len == 0; ++iov)
+          --count;
+        if (count == 0)
+          return true;
+
+        const ssize_t n = transfer(iov, count);
+        if (n < 0 && errno == EINTR)
+          continue;
+        if (n < 0)
+          throw std::system_error(errno, std::generic_category(), what);
+        if (n == 0)
+          return false;
+
+        std::size_t done = static_cast<std::size_t>(n);
+        for (; done != 0 && done >= iov->iov_len; ++iov, --count)
+          done -= iov->iov_len;
+        if (done != 0) {
+          iov->iov_base = static_cast<char*>(iov->iov_base) + done;
+          iov->iov_len -= done;
+        }
+      }
+    }
+  } // namespace detail
+
+  // Fills the free space of a byte ring straight from fd with a single readv and
+  // appends what was read. Returns the number of bytes read, 0 at end of file, or -1
+  // with errno set ( EAGAIN included, ENOBUFS when the ring is full ), in which case
+  // the ring is left unchanged. Interrupted calls are retried.
+  template<class Buffer>
+  ssize_t read_from(int fd, Buffer& buffer) JM_CB_NOEXCEPT
+  {
+    static_assert(sizeof(typename Buffer::value_type) == 1, "read_from works on byte buffers");
+
+    iovec     iov[2];
+    const int count = detail::to_iovec(iov, buffer.free_array_one(), buffer.free_array_two());
+    if (JM_CB_UNLIKELY(iov[0].iov_len == 0)) {
+      errno = ENOBUFS;
+      return -1;
+    }
+
+    ssize_t n;
+    do
+      n = ::readv(fd, iov, count);
+    while (n < 0 && errno == EINTR);
+
+    if (n > 0)
+      buffer.commit_back(static_cast<std::size_t>(n));
+    return n;
+  }
+
+  // Drains the content of a byte ring to fd with a single writev and pops what was
+  // written, which may be only a part of it. Returns the number of bytes written, 0
+  // if the ring is empty, or -1 with errno set, in which case the ring is unchanged.
+  template<class Buffer>
+  ssize_t write_to(int fd, Buffer& buffer) JM_CB_NOEXCEPT
+  {
+    static_assert(sizeof(typename Buffer::value_type) == 1, "write_to works on byte buffers");
+
+    if (buffer.empty())
+      return 0;
+
+    iovec     iov[2];
+    const int count = detail::to_iovec(iov, buffer.array_one(), buffer.array_two());
+
+    ssize_t n;
+    do
+      n = ::writev(fd, iov, count);
+    while (n < 0 && errno == EINTR);
+
+    if (n > 0)
+      buffer.erase_begin(static_cast<std::size_t>(n));
+    return n;
+  }
+
+  // snapshot of buffer written with a single writev ( repeated on partial writes ),
+  // in the format of save(std::ostream&, const Buffer&)
+  template<class Buffer>
+  void save(int fd, const Buffer& buffer)
+  {
+    typedef typename Buffer::value_type T;
+
+    snapshot_header header = detail::make_snapshot_header(buffer);
+    const auto      one = buffer.array_one();
+    const auto      two = buffer.array_two();
+
+    iovec iov[3];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = const_cast<T*>(one.first);
+    iov[1].iov_len = one.second * sizeof(T);
+    iov[2].iov_base = const_cast<T*>(two.first);
+    iov[2].iov_len = two.second * sizeof(T);
+
+    const auto write = [fd](const iovec* v, int n) { return ::writev(fd, v, n); };
+    detail::transfer_all(write, iov, 3, "failed to write circular buffer snapshot");
+  }
+
+  // replaces the content of buffer with a snapshot read by fd straight into its free
+  // segments. The header is read on its own first: the storage the elements go to is
+  // only known once it is validated ( a dynamic_circular_buffer may be reallocated ),
+  // and reading ahead of it could consume bytes past the end of the snapshot. Both
+  // segments are then filled by a single readv. On failure the buffer is left empty.
+  // max_capacity bounds the capacity a dynamic_circular_buffer takes, as for the
+  // stream load
+  template<class Buffer>
+  void load(int fd, Buffer& buffer, std::size_t max_capacity = std::numeric_limits<std::size_t>::max())
+  {
+    typedef typename Buffer::value_type T;
+
+    snapshot_header header;
+    iovec           iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+
+    const auto read = [fd](const iovec* v, int n) { return ::readv(fd, v, n); };
+    if (!detail::transfer_all(read, iov, 1, "failed to read circular buffer snapshot"))
+      throw std::runtime_error("truncated circular buffer snapshot");
+    detail::validate_and_prepare(buffer, header, max_capacity);
+
+    const std::size_t size = static_cast<std::size_t>(header.size);
+    const auto        one = buffer.free_array_one();
+    const auto        two = buffer.free_array_two();
+    const std::size_t first = std::min(size, one.second);
+    iov[0].iov_base = one.first;
+    iov[0].iov_len = first * sizeof(T);
+    iov[1].iov_base = two.first;
+    iov[1].iov_len = (size - first) * sizeof(T);
+
+    if (!detail::transfer_all(read, iov, 2, "failed to read circular buffer snapshot"))
+      throw std::runtime_error("truncated circular buffer snapshot");
+    buffer.commit_back(size);
+  }
+} // namespace jm
+
+#endif // JM_FD_IO_HPP
@@ -0,0 +1,102 @@
+#ifndef JM_FIR_FILTER_HPP
+#define JM_FIR_FILTER_HPP
+
+#include <circular_buffer/static_circular_buffer.hpp>
+#include <circular_buffer/dynamic_circular_buffer.hpp>
+
+namespace jm {
+  // Streaming FIR filter y[n] = sum h[k] * x[n - k] that reads its history straight
+  // from the two contiguous segments of the input ring, without unwrapping it.
+  //
+  // Outputs are produced in blocks: for every tap the whole block is updated with one
+  // y[j] += h[k] * x[j - k] pass over contiguous memory. The passes have no loop
+  // carried dependency, so they are vectorized by the compiler without reassociating
+  // floating point sums, and the result is bit-exact regardless of the SIMD width.
+  template<typename T>
+  class fir_filter {
+  public:
+    typedef T              value_type;
+    typedef std::size_t    size_type;
+    typedef std::ptrdiff_t difference_type;
+
+  private:
+    static JM_CB_CONSTEXPR size_type block_size = 256;
+
+    std::vector<T> _taps;
+
+    static void axpy(T* JM_CB_RESTRICT y, const T* JM_CB_RESTRICT x, size_type n, T h) JM_CB_NOEXCEPT
+    {
+      for (size_type i = 0; i < n; ++i)
+        y[i] += h * x[i];
+    }
+
+    // acc[i] += h * x[first + i] for the logical input range [first, first + n)
+    static void accumulate(T* acc, const T* one, size_type one_len, const T* two,
+                           size_type first, size_type n, T h) JM_CB_NOEXCEPT
+    {
+      if (first < one_len) {
+        const size_type len = std::min(n, one_len - first);
+        axpy(acc, one + first, len, h);
+        acc += len;
+        n -= len;
+        first = one_len;
+      }
+
+      if (n != 0)
+        axpy(acc, two + (first - one_len), n, h);
+    }
+
+  public:
+    template<typename InputIt>
+    fir_filter(InputIt first, InputIt last) : _taps(first, last)
+    {}
+
+    fir_filter(std::initializer_list<T> taps) : _taps(taps) {}
+
+    // matched filter: correlates the input with the given template
+    template<typename InputIt>
+    static fir_filter correlator(InputIt first, InputIt last)
+    {
+      fir_filter filter(first, last);
+      std::reverse(filter._taps.begin(), filter._taps.end());
+      return filter;
+    }
+
+    size_type size() const JM_CB_NOEXCEPT { return _taps.size(); }
+
+    const std::vector<T>& taps() const JM_CB_NOEXCEPT { return _taps; }
+
+    // filters the newest count samples of in and pushes count outputs to out.
+    // history older than the oldest sample in the ring is treated as zero.
+    template<class InBuffer, class OutBuffer>
+    void process(const InBuffer& in, size_type count, OutBuffer& out) const
+    {
+      JM_ASSERT(count <= in.size(), "count exceeds the number of buffered samples");
+
+      const auto      one = in.array_one();
+      const auto      two = in.array_two();
+      const size_type start = in.size() - count;
+
+      T acc[block_size];
+      for (size_type done = 0; done < count; done += block_size) {
+        const size_type n = std::min(block_size, count - done);
+        std::fill(acc, acc + n, T());
+
+        // output j of this block reads input start + done + j - k
+        const size_type base = start + done;
+        for (size_type k = 0; k < _taps.size(); ++k) {
+          if (base + n <= k)
+            break;
+
+          const size_type skip = k > base ? k - base : 0;
+          accumulate(acc + skip, one.first, one.second, two.first, base + skip - k, n - skip, _taps[k]);
+        }
+
+        for (size_type j = 0; j < n; ++j)
+          out.push_back(acc[j]);
+      }
+    }
+  };
+} // namespace jm
+
+#endif // JM_FIR_FILTER_HPP
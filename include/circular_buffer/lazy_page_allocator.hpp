@@ -0,0 +1,110 @@
+#ifndef JM_LAZY_PAGE_ALLOCATOR_HPP
+#define JM_LAZY_PAGE_ALLOCATOR_HPP
+
+// POSIX only, not included by circular_buffer.hpp
+
+#include <circular_buffer/dynamic_circular_buffer.hpp>
+
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+namespace jm {
+  // Allocator for very large rings: memory is only reserved as address space with an
+  // anonymous mapping, and elements are default initialized instead of value
+  // initialized, so a page is committed by the kernel when the ring first writes to
+  // it rather than when the ring is created.
+  template<typename T>
+  class lazy_page_allocator {
+  public:
+    typedef T value_type;
+
+    template<typename U>
+    struct rebind {
+      typedef lazy_page_allocator<U> other;
+    };
+
+    lazy_page_allocator() JM_CB_NOEXCEPT {}
+
+    template<typename U>
+    lazy_page_allocator(const lazy_page_allocator<U>&) JM_CB_NOEXCEPT
+    {}
+
+    T* allocate(std::size_t n)
+    {
+      void* p = ::mmap(JM_CB_NULLPTR, n * sizeof(T), PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      if (p == MAP_FAILED)
+        throw std::bad_alloc();
+      return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, std::size_t n) JM_CB_NOEXCEPT { ::munmap(p, n * sizeof(T)); }
+
+    // default initialization leaves trivial elements, and so their pages, untouched
+    template<typename U>
+    void construct(U* p) JM_CB_NOEXCEPT(std::is_nothrow_default_constructible<U>::value)
+    {
+      ::new (static_cast<void*>(p)) U;
+    }
+
+    template<typename U, typename... Args>
+    void construct(U* p, Args&&... args)
+    {
+      ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+  };
+
+  template<typename T, typename U>
+  inline bool operator==(const lazy_page_allocator<T>&, const lazy_page_allocator<U>&) JM_CB_NOEXCEPT
+  {
+    return true;
+  }
+
+  template<typename T, typename U>
+  inline bool operator!=(const lazy_page_allocator<T>&, const lazy_page_allocator<U>&) JM_CB_NOEXCEPT
+  {
+    return false;
+  }
+
+  // Reclamation is manual: popping never returns pages to the OS, so once the tail has
+  // gone around the ring its whole capacity stays resident until reclaim_unused_pages
+  // is called, typically every few megabytes consumed.
+  template<typename T>
+  using lazy_circular_buffer = dynamic_circular_buffer<T, lazy_page_allocator<T>>;
+
+  namespace detail {
+    template<class Range>
+    inline std::size_t advise_whole_pages(const Range& range, int advice) JM_CB_NOEXCEPT
+    {
+      const std::uintptr_t page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+      const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(range.first);
+      const std::uintptr_t end = begin + range.second * sizeof(*range.first);
+      const std::uintptr_t first = (begin + page - 1) & ~(page - 1);
+      const std::uintptr_t last = end & ~(page - 1);
+      if (first >= last || ::madvise(reinterpret_cast<void*>(first), last - first, advice) != 0)
+        return 0;
+      return last - first;
+    }
+  } // namespace detail
+
+  // Returns the pages lying entirely in the free space of buffer to the OS, so that
+  // resident memory follows the content of the ring rather than its capacity. The
+  // pages are committed again, zeroed, when the ring wraps around to them. Returns the
+  // number of bytes released.
+  template<class Buffer>
+  std::size_t reclaim_unused_pages(Buffer& buffer, int advice = MADV_DONTNEED) JM_CB_NOEXCEPT
+  {
+    static_assert(std::is_trivially_copyable<typename Buffer::value_type>::value,
+                  "free slots of the buffer still hold objects that would lose their state");
+
+    return detail::advise_whole_pages(buffer.free_array_one(), advice) +
+           detail::advise_whole_pages(buffer.free_array_two(), advice);
+  }
+} // namespace jm
+
+#endif // JM_LAZY_PAGE_ALLOCATOR_HPP
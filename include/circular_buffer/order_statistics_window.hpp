@@ -0,0 +1,104 @@
+#ifndef JM_ORDER_STATISTICS_WINDOW_HPP
+#define JM_ORDER_STATISTICS_WINDOW_HPP
+
+#include <circular_buffer/static_circular_buffer.hpp>
+#include <circular_buffer/dynamic_circular_buffer.hpp>
+#include <circular_buffer/detail/indexable_skiplist.hpp>
+
+namespace jm {
+  // Sliding window that keeps its elements both in arrival order ( Buffer ) and in
+  // sorted order ( indexable skiplist ). push() / pop() are O(log N), median() and any
+  // other order statistic are O(log N). Values must be strictly weakly ordered by
+  // Compare, so NaN is not allowed in floating point windows.
+  template<class Buffer, class Compare = std::less<typename Buffer::value_type>>
+  class order_statistics_window {
+  public:
+    typedef Buffer                      buffer_type;
+    typedef typename Buffer::value_type value_type;
+    typedef typename Buffer::size_type  size_type;
+    typedef const value_type&           const_reference;
+
+  private:
+    Buffer                                          _values;
+    detail::indexable_skiplist<value_type, Compare> _sorted;
+
+  public:
+    explicit order_statistics_window(const Compare& comp = Compare()) : _values(), _sorted(comp)
+    {
+      _sorted.reserve(_values.max_size());
+    }
+
+    /// capacity
+    void reserve(size_type window)
+    {
+      _values.reserve(window);
+      _sorted.reserve(window);
+    }
+
+    bool empty() const JM_CB_NOEXCEPT { return _values.empty(); }
+
+    bool full() const JM_CB_NOEXCEPT { return _values.full(); }
+
+    size_type size() const JM_CB_NOEXCEPT { return _values.size(); }
+
+    size_type max_size() const JM_CB_NOEXCEPT { return _values.max_size(); }
+
+    /// element access
+    const Buffer& buffer() const JM_CB_NOEXCEPT { return _values; }
+
+    // k-th smallest element of the window, 0 based
+    const_reference nth(size_type k) const JM_CB_NOEXCEPT { return _sorted[k]; }
+
+    const_reference min() const JM_CB_NOEXCEPT { return _sorted[0]; }
+
+    const_reference max() const JM_CB_NOEXCEPT
+    {
+      JM_ASSERT(!empty(), "There are empty buffer");
+      return _sorted[size() - 1];
+    }
+
+    // element at rank size() / 2, the same one std::nth_element picks
+    const_reference median() const JM_CB_NOEXCEPT { return _sorted[size() / 2]; }
+
+    // element at rank floor(q * (size() - 1)), q in [0, 1]
+    const_reference quantile(double q) const JM_CB_NOEXCEPT
+    {
+      JM_ASSERT(!empty(), "There are empty buffer");
+      JM_ASSERT(q >= 0. && q <= 1., "quantile out of [0, 1]");
+      return _sorted[static_cast<size_type>(q * static_cast<double>(size() - 1))];
+    }
+
+    /// modifiers
+    // pushes a new element, evicting the oldest one if the window is full
+    void push(const value_type& value)
+    {
+      if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_values.full()))
+        _sorted.erase(_values.front());
+
+      _sorted.insert(value);
+      _values.push_back(value);
+    }
+
+    void pop()
+    {
+      JM_ASSERT(!empty(), "There are empty buffer");
+      _sorted.erase(_values.front());
+      _values.pop_front();
+    }
+
+    void clear()
+    {
+      _values.clear();
+      _sorted.clear();
+    }
+  };
+
+  template<class T, std::size_t N, class Compare = std::less<T>>
+  using static_order_statistics_window = order_statistics_window<static_circular_buffer<T, N>, Compare>;
+
+  template<class T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
+  using dynamic_order_statistics_window =
+    order_statistics_window<dynamic_circular_buffer<T, Allocator>, Compare>;
+} // namespace jm
+
+#endif // JM_ORDER_STATISTICS_WINDOW_HPP
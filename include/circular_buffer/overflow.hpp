@@ -0,0 +1,61 @@
+#ifndef JM_OVERFLOW_HPP
+#define JM_OVERFLOW_HPP
+
+#include <circular_buffer/config.hpp>
+
+namespace jm {
+  // What push_* / emplace_* do when the buffer is full, chosen at compile time with
+  // the Overflow template parameter. They return false only with reject.
+  namespace overflow {
+    // the new element replaces the oldest one at the other end
+    struct overwrite {
+    };
+
+    // the buffer is left unchanged
+    struct reject {
+    };
+
+    // std::length_error is thrown, the buffer is left unchanged
+    struct throw_exception {
+    };
+
+    // dynamic_circular_buffer only, the capacity doubles
+    struct grow {
+    };
+  } // namespace overflow
+
+  namespace detail {
+    template<class Overflow>
+    struct overflow_traits;
+
+    template<>
+    struct overflow_traits<overflow::overwrite> {
+      static JM_CB_CONSTEXPR bool overwrites = true;
+      static JM_CB_CONSTEXPR bool grows = false;
+    };
+
+    template<>
+    struct overflow_traits<overflow::reject> {
+      static JM_CB_CONSTEXPR bool overwrites = false;
+      static JM_CB_CONSTEXPR bool grows = false;
+
+      static bool refuse(const char*) JM_CB_NOEXCEPT { return false; }
+    };
+
+    template<>
+    struct overflow_traits<overflow::throw_exception> {
+      static JM_CB_CONSTEXPR bool overwrites = false;
+      static JM_CB_CONSTEXPR bool grows = false;
+
+      static bool refuse(const char* what) { throw std::length_error(what); }
+    };
+
+    template<>
+    struct overflow_traits<overflow::grow> {
+      static JM_CB_CONSTEXPR bool overwrites = false;
+      static JM_CB_CONSTEXPR bool grows = true;
+    };
+  } // namespace detail
+} // namespace jm
+
+#endif // JM_OVERFLOW_HPP
@@ -0,0 +1,130 @@
+#ifndef JM_RANGE_SUM_INDEX_HPP
+#define JM_RANGE_SUM_INDEX_HPP
+
+#include <circular_buffer/dynamic_circular_buffer.hpp>
+
+namespace jm {
+  // dynamic_circular_buffer paired with a segment tree over its slots, so that the sum
+  // of any contiguous sub-window is O(log N). Every node is recomputed from its children
+  // when a slot is overwritten instead of being patched with a delta, so floating point
+  // sums never drift and an evicted outlier leaves no residue behind. A default
+  // constructed index has no capacity and must be reserve()d before the first push_back().
+  template<typename T, class Allocator = std::allocator<T>>
+  class range_sum_index {
+  public:
+    typedef dynamic_circular_buffer<T, Allocator> buffer_type;
+    typedef T                                     value_type;
+    typedef std::size_t                           size_type;
+    typedef const T&                              const_reference;
+
+  private:
+    buffer_type               _values;
+    std::vector<T, Allocator> _tree;
+    size_type                 _first; // tree slot of the oldest element
+
+    inline size_type slot(size_type logical) const JM_CB_NOEXCEPT
+    {
+      const size_type capacity = _values.max_size();
+      const size_type s = _first + logical;
+      return s >= capacity ? s - capacity : s;
+    }
+
+    void assign(size_type slot_idx, const T& value)
+    {
+      size_type node = slot_idx + _values.max_size();
+      _tree[node] = value;
+      for (node >>= 1; node != 0; node >>= 1)
+        _tree[node] = _tree[2 * node] + _tree[2 * node + 1];
+    }
+
+    // sum of the tree slots [l, r)
+    T slot_sum(size_type l, size_type r) const
+    {
+      T left = T(), right = T();
+      for (l += _values.max_size(), r += _values.max_size(); l < r; l >>= 1, r >>= 1) {
+        if (l & 1)
+          left = left + _tree[l++];
+        if (r & 1)
+          right = _tree[--r] + right;
+      }
+      return left + right;
+    }
+
+  public:
+    explicit range_sum_index(size_type capacity = 0) : _values(capacity), _tree(2 * capacity), _first(0) {}
+
+    /// capacity
+    void reserve(size_type new_cap)
+    {
+      _values.reserve(new_cap);
+      _tree.assign(2 * new_cap, T());
+      _first = 0;
+    }
+
+    bool empty() const JM_CB_NOEXCEPT { return _values.empty(); }
+
+    bool full() const JM_CB_NOEXCEPT { return _values.full(); }
+
+    size_type size() const JM_CB_NOEXCEPT { return _values.size(); }
+
+    size_type max_size() const JM_CB_NOEXCEPT { return _values.max_size(); }
+
+    /// element access
+    const buffer_type& buffer() const JM_CB_NOEXCEPT { return _values; }
+
+    const_reference front() const JM_CB_NOEXCEPT { return _values.front(); }
+
+    const_reference back() const JM_CB_NOEXCEPT { return _values.back(); }
+
+    /// queries
+    // sum of the elements [first, last), 0 being the oldest one
+    T sum(size_type first, size_type last) const
+    {
+      JM_ASSERT(first <= last && last <= size(), "range out of buffer");
+      if (first == last)
+        return T();
+
+      const size_type l = slot(first);
+      const size_type r = slot(last - 1) + 1;
+      if (l < r)
+        return slot_sum(l, r);
+      return slot_sum(l, _values.max_size()) + slot_sum(0, r);
+    }
+
+    // sum of the newest k elements
+    T sum_last(size_type k) const { return sum(size() - k, size()); }
+
+    T total() const { return sum(0, size()); }
+
+    /// modifiers
+    void push_back(const value_type& value)
+    {
+      JM_ASSERT(max_size() != 0, "index has no capacity, reserve() it first");
+      if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_values.full())) {
+        assign(_first, value);
+        _first = slot(1);
+      }
+      else
+        assign(slot(_values.size()), value);
+
+      _values.push_back(value);
+    }
+
+    void pop_front()
+    {
+      JM_ASSERT(!empty(), "There are empty buffer");
+      assign(_first, T());
+      _first = slot(1);
+      _values.pop_front();
+    }
+
+    void clear()
+    {
+      _values.clear();
+      std::fill(_tree.begin(), _tree.end(), T());
+      _first = 0;
+    }
+  };
+} // namespace jm
+
+#endif // JM_RANGE_SUM_INDEX_HPP
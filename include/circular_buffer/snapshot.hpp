@@ -0,0 +1,127 @@
+#ifndef JM_SNAPSHOT_HPP
+#define JM_SNAPSHOT_HPP
+
+#include <circular_buffer/static_circular_buffer.hpp>
+#include <circular_buffer/dynamic_circular_buffer.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+
+namespace jm {
+  // Binary snapshot format: this header followed by the elements, oldest first.
+  struct snapshot_header {
+    static JM_CB_CONSTEXPR std::uint32_t current_version = 1;
+
+    char          magic[4];
+    std::uint32_t version;
+    std::uint64_t capacity;
+    std::uint64_t size;
+    std::uint32_t element_size;
+    std::uint32_t element_alignment;
+  };
+
+  namespace detail {
+    template<class Buffer>
+    inline snapshot_header make_snapshot_header(const Buffer& buffer) JM_CB_NOEXCEPT
+    {
+      typedef typename Buffer::value_type T;
+      static_assert(std::is_trivially_copyable<T>::value, "snapshots copy the elements as bytes");
+
+      snapshot_header header;
+      std::memcpy(header.magic, "JMCB", 4);
+      header.version = snapshot_header::current_version;
+      header.capacity = buffer.max_size();
+      header.size = buffer.size();
+      header.element_size = sizeof(T);
+      header.element_alignment = alignof(T);
+      return header;
+    }
+
+    template<class T, std::size_t N, class Overflow, class Stats>
+    inline void prepare_load(static_circular_buffer<T, N, Overflow, Stats>& buffer, const snapshot_header& header,
+                             std::size_t /* max_capacity */)
+    {
+      if (header.capacity != N)
+        throw std::runtime_error("snapshot capacity does not match static_circular_buffer<T, N>");
+      buffer.clear();
+    }
+
+    template<class T, class Allocator, class Overflow, class Stats>
+    inline void prepare_load(dynamic_circular_buffer<T, Allocator, Overflow, Stats>& buffer, const snapshot_header& header,
+                             std::size_t max_capacity)
+    {
+      // the capacity comes from the stream, it must not drive an unbounded allocation
+      if (header.capacity > std::numeric_limits<std::size_t>::max() / sizeof(T))
+        throw std::runtime_error("corrupted circular buffer snapshot");
+      if (header.capacity > max_capacity)
+        throw std::runtime_error("snapshot capacity exceeds max_capacity");
+      buffer.reserve(static_cast<std::size_t>(header.capacity));
+    }
+
+    // checks that a snapshot fits Buffer, then empties the buffer to receive it
+    template<class Buffer>
+    inline void validate_and_prepare(Buffer& buffer, const snapshot_header& header, std::size_t max_capacity)
+    {
+      typedef typename Buffer::value_type T;
+      static_assert(std::is_trivially_copyable<T>::value, "snapshots copy the elements as bytes");
+
+      if (std::memcmp(header.magic, "JMCB", 4) != 0)
+        throw std::runtime_error("not a circular buffer snapshot");
+      if (header.version != snapshot_header::current_version)
+        throw std::runtime_error("unsupported circular buffer snapshot version");
+      if (header.element_size != sizeof(T) || header.element_alignment != alignof(T))
+        throw std::runtime_error("snapshot element type does not match the buffer");
+      if (header.size > header.capacity)
+        throw std::runtime_error("corrupted circular buffer snapshot");
+
+      prepare_load(buffer, header, max_capacity);
+    }
+  } // namespace detail
+
+  // writes the header and the two segments of buffer
+  template<class Buffer>
+  void save(std::ostream& os, const Buffer& buffer)
+  {
+    typedef typename Buffer::value_type T;
+
+    const snapshot_header header = detail::make_snapshot_header(buffer);
+    const auto            one = buffer.array_one();
+    const auto            two = buffer.array_two();
+
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char*>(one.first), static_cast<std::streamsize>(one.second * sizeof(T)));
+    os.write(reinterpret_cast<const char*>(two.first), static_cast<std::streamsize>(two.second * sizeof(T)));
+    if (!os)
+      throw std::runtime_error("failed to write circular buffer snapshot");
+  }
+
+  // replaces the content of buffer with a snapshot, read straight into its storage.
+  // a dynamic_circular_buffer takes the capacity of the snapshot, which is rejected
+  // above max_capacity: bound it when the snapshot is not trusted
+  template<class Buffer>
+  void load(std::istream& is, Buffer& buffer, std::size_t max_capacity = std::numeric_limits<std::size_t>::max())
+  {
+    typedef typename Buffer::value_type T;
+
+    snapshot_header header;
+    if (!is.read(reinterpret_cast<char*>(&header), sizeof(header)))
+      throw std::runtime_error("failed to read circular buffer snapshot");
+    detail::validate_and_prepare(buffer, header, max_capacity);
+
+    const std::size_t size = static_cast<std::size_t>(header.size);
+    const auto        one = buffer.free_array_one();
+    const auto        two = buffer.free_array_two();
+    const std::size_t first = std::min(size, one.second);
+
+    is.read(reinterpret_cast<char*>(one.first), static_cast<std::streamsize>(first * sizeof(T)));
+    is.read(reinterpret_cast<char*>(two.first), static_cast<std::streamsize>((size - first) * sizeof(T)));
+    if (!is)
+      throw std::runtime_error("truncated circular buffer snapshot");
+    buffer.commit_back(size);
+  }
+} // namespace jm
+
+#endif // JM_SNAPSHOT_HPP
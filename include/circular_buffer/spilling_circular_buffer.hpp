@@ -0,0 +1,193 @@
+#ifndef JM_SPILLING_CIRCULAR_BUFFER_HPP
+#define JM_SPILLING_CIRCULAR_BUFFER_HPP
+
+#include <circular_buffer/dynamic_circular_buffer.hpp>
+
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#if defined(__unix__)
+#include <fcntl.h>
+#endif
+
+namespace jm {
+  namespace detail {
+    // hints that the bytes [offset, offset + length) of file, 0 length meaning up to
+    // its end, are read sequentially and soon, so the kernel reads them ahead into the
+    // page cache in the background. Only where posix_fadvise exists, failures are
+    // ignored
+    inline void advise_read_ahead(std::FILE* file, std::size_t offset, std::size_t length) JM_CB_NOEXCEPT
+    {
+#ifdef POSIX_FADV_WILLNEED
+      const int fd = ::fileno(file);
+      if (offset == 0 && length == 0)
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+      else
+        ::posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+#else
+      (void)file;
+      (void)offset;
+      (void)length;
+#endif
+    }
+  } // namespace detail
+
+  // FIFO that keeps its newest elements in a dynamic_circular_buffer and, instead of
+  // overwriting, spills the oldest ones to temporary files once the ring is full.
+  // Spilled elements are written in large sequential appends to segments of
+  // segment_size elements and replayed, before the ones in memory, through a replay
+  // buffer refilled with large sequential reads. Each refill asks the kernel to read
+  // the next chunk ahead, where posix_fadvise exists, so the following one is served
+  // from the page cache instead of stalling on the disk. Memory use stays bounded by
+  // the ring and the replay buffer whatever the burst size; a fully replayed segment
+  // is deleted.
+  template<typename T, class Allocator = std::allocator<T>>
+  class spilling_circular_buffer {
+    static_assert(std::is_trivially_copyable<T>::value, "spilled elements are stored as bytes");
+
+  public:
+    typedef T                                     value_type;
+    typedef std::size_t                           size_type;
+    typedef dynamic_circular_buffer<T, Allocator> buffer_type;
+
+  private:
+    struct file_closer {
+      void operator()(std::FILE* file) const JM_CB_NOEXCEPT { std::fclose(file); }
+    };
+
+    struct segment {
+      std::unique_ptr<std::FILE, file_closer> file;
+      size_type                               written;
+      size_type                               read;
+    };
+
+    buffer_type         _memory;
+    std::deque<segment> _segments; // oldest first
+    std::vector<T>      _replay;
+    size_type           _replay_pos;
+    size_type           _replay_end;
+    size_type           _segment_size;
+    size_type           _spilled; // elements in the segments and the replay buffer
+
+    // moves at least half of the ring, oldest first, to the newest segment
+    void spill()
+    {
+      const size_type target = std::max<size_type>(_memory.size() / 2, 1);
+      for (size_type moved = 0; moved < target;) {
+        if (_segments.empty() || _segments.back().written == _segment_size) {
+          segment s{ std::unique_ptr<std::FILE, file_closer>(std::tmpfile()), 0, 0 };
+          if (!s.file)
+            throw std::runtime_error("spilling_circular_buffer could not create a temporary file");
+          detail::advise_read_ahead(s.file.get(), 0, 0);
+          _segments.push_back(std::move(s));
+        }
+
+        segment&        back = _segments.back();
+        const auto      one = _memory.array_one();
+        const size_type count = std::min(one.second, _segment_size - back.written);
+        if (std::fseek(back.file.get(), 0, SEEK_END) != 0 ||
+            std::fwrite(one.first, sizeof(T), count, back.file.get()) != count)
+          throw std::runtime_error("spilling_circular_buffer failed to write a segment");
+
+        back.written += count;
+        _memory.erase_begin(count);
+        _spilled += count;
+        moved += count;
+      }
+    }
+
+    // refills the replay buffer from the oldest segment, then starts reading the next
+    // chunk ahead
+    void replay()
+    {
+      segment&        front = _segments.front();
+      const size_type count = std::min(_replay.size(), front.written - front.read);
+      if (std::fseek(front.file.get(), static_cast<long>(front.read * sizeof(T)), SEEK_SET) != 0 ||
+          std::fread(_replay.data(), sizeof(T), count, front.file.get()) != count)
+        throw std::runtime_error("spilling_circular_buffer failed to read a segment");
+
+      front.read += count;
+      _replay_pos = 0;
+      _replay_end = count;
+      // only the newest segment can still be appended to
+      if (front.read == _segment_size)
+        _segments.pop_front();
+
+      if (!_segments.empty()) {
+        const segment& next = _segments.front();
+        detail::advise_read_ahead(next.file.get(), next.read * sizeof(T), _replay.size() * sizeof(T));
+      }
+    }
+
+    bool replaying() const JM_CB_NOEXCEPT { return _replay_pos != _replay_end; }
+
+  public:
+    // memory_capacity elements are kept in memory, spilled ones are replayed in
+    // chunks of replay_size elements
+    explicit spilling_circular_buffer(size_type memory_capacity, size_type segment_size = 1 << 20,
+                                      size_type replay_size = 1 << 14)
+      : _memory(memory_capacity), _segments(), _replay(std::max<size_type>(replay_size, 1)), _replay_pos(0),
+        _replay_end(0), _segment_size(std::max<size_type>(segment_size, 1)), _spilled(0)
+    {
+      JM_ASSERT(memory_capacity != 0, "the ring needs room for at least one element");
+    }
+
+    /// capacity
+    bool empty() const JM_CB_NOEXCEPT { return size() == 0; }
+
+    size_type size() const JM_CB_NOEXCEPT { return _spilled + _memory.size(); }
+
+    // elements currently on disk or waiting in the replay buffer
+    size_type spilled() const JM_CB_NOEXCEPT { return _spilled; }
+
+    size_type memory_capacity() const JM_CB_NOEXCEPT { return _memory.max_size(); }
+
+    const buffer_type& memory() const JM_CB_NOEXCEPT { return _memory; }
+
+    /// element access
+    // the oldest element, replayed from disk if it was spilled
+    const T& front()
+    {
+      JM_ASSERT(!empty(), "There are empty buffer");
+      if (!replaying() && _spilled != 0)
+        replay();
+      return replaying() ? _replay[_replay_pos] : _memory.front();
+    }
+
+    /// modifiers
+    // appends value, spilling the oldest elements to disk if the ring is full
+    void push_back(const value_type& value)
+    {
+      if (JM_CB_UNLIKELY(_memory.full()))
+        spill();
+      _memory.push_back(value);
+    }
+
+    void pop_front()
+    {
+      JM_ASSERT(!empty(), "There are empty buffer");
+      if (!replaying() && _spilled != 0)
+        replay();
+
+      if (replaying()) {
+        ++_replay_pos;
+        --_spilled;
+      }
+      else
+        _memory.pop_front();
+    }
+
+    // drops everything, temporary files included
+    void clear()
+    {
+      _memory.clear();
+      _segments.clear();
+      _replay_pos = _replay_end = 0;
+      _spilled = 0;
+    }
+  };
+} // namespace jm
+
+#endif // JM_SPILLING_CIRCULAR_BUFFER_HPP
@@ -2,12 +2,19 @@
 #define JM_STATIC_CIRCULAR_BUFFER_HPP
 
 #include <circular_buffer/detail/static_iterator.hpp>
+#include <circular_buffer/detail/ring_move.hpp>
+#include <circular_buffer/buffer_stats.hpp>
+#include <circular_buffer/overflow.hpp>
+
+#include <limits>
 
 namespace jm {
-  template<typename T, std::size_t N>
-  class static_circular_buffer {
+  // Overflow is one of the jm::overflow policies except grow, Stats is
+  // null_buffer_stats or buffer_stats
+  template<typename T, std::size_t N, class Overflow = overflow::overwrite, class Stats = null_buffer_stats>
+  class static_circular_buffer : private Stats {
   public:
-    typedef std::array<detail::optional_storage<T>, N>             container;
+    typedef detail::slot_array<T, N>                               container;
     typedef T                                                      value_type;
     typedef std::size_t                                            size_type;
     typedef std::ptrdiff_t                                         difference_type;
@@ -20,19 +27,50 @@ namespace jm {
       const_iterator;
     typedef std::reverse_iterator<iterator>       reverse_iterator;
     typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    typedef std::pair<pointer, size_type>         array_range;
+    typedef std::pair<const_pointer, size_type>   const_array_range;
+    typedef Overflow                              overflow_policy;
 
   private:
     typedef detail::cb_index_wrapper<size_type, N> wrapper_t;
     typedef detail::optional_storage<T>            storage_type;
+    typedef detail::overflow_traits<Overflow>      overflow_traits;
+
+    static_assert(!overflow_traits::grows, "only dynamic_circular_buffer can grow");
+
+    static_assert(sizeof(storage_type) == sizeof(T),
+      "segment access treats the storage as a plain array of T");
 
     size_type    _head;
     size_type    _tail;
     size_type    _size;
     container    _buffer;
 
-    inline void destroy(size_type idx) JM_CB_NOEXCEPT { _buffer[idx]._value.~T(); }
+    JM_CB_CXX20_CONSTEXPR void destroy(size_type idx) JM_CB_NOEXCEPT { std::destroy_at(JM_CB_ADDRESSOF(_buffer[idx]._value)); }
 
-    inline void copy_buffer(const static_circular_buffer& other)
+    // before the first element is constructed into an empty ring, constant evaluation
+    // activates the slots. A default constructed buffer leaves them untouched so that
+    // it is constant initialized even where is_constant_evaluated() is not honoured
+    JM_CB_CXX20_CONSTEXPR void activate_slots_if_empty() JM_CB_NOEXCEPT
+    {
+      if (JM_CB_IS_CONSTANT_EVALUATED() && _size == 0)
+        _buffer.activate();
+    }
+
+    JM_CB_CXX14_CONSTEXPR iterator iterator_at(size_type k) JM_CB_NOEXCEPT
+    {
+      return k == _size ? end() : iterator(_buffer.data(), wrapper_t::advance(_head, k), _size - k);
+    }
+
+    // pops the elements consumed so far when it goes out of scope, even by an exception
+    struct consume_guard {
+      static_circular_buffer& buffer;
+      size_type               count;
+
+      JM_CB_CXX20_CONSTEXPR ~consume_guard() { buffer.erase_begin(count); }
+    };
+
+    JM_CB_CXX20_CONSTEXPR void copy_buffer(const static_circular_buffer& other)
     {
       const_iterator       first = other.cbegin();
       const const_iterator last = other.cend();
@@ -41,7 +79,7 @@ namespace jm {
         push_back(*first);
     }
 
-    inline void move_buffer(static_circular_buffer&& other)
+    JM_CB_CXX20_CONSTEXPR void move_buffer(static_circular_buffer&& other)
     {
       iterator       first = other.begin();
       const iterator last = other.end();
@@ -51,36 +89,40 @@ namespace jm {
     }
 
   public:
+    // O(1), the slots are left uninitialized
     JM_CB_CONSTEXPR explicit static_circular_buffer()
-      : _head(1), _tail(0), _size(0), _buffer()
+      : _head(1), _tail(0), _size(0)
     {  }
 
-    explicit
+    JM_CB_CXX20_CONSTEXPR explicit
       static_circular_buffer(size_type count, const T& value = T())
-      : _head(0), _tail(count - 1), _size(count), _buffer()
+      : _head(0), _tail(count - 1), _size(count)
     {
       if (JM_CB_UNLIKELY(_size > N))
         throw std::out_of_range(
           "circular_buffer<T, N>(size_type count, const T&) count exceeded N");
 
+      _buffer.activate();
+
       if (JM_CB_LIKELY(_size != 0))
         for (size_type i = 0; i < count; ++i)
-          new(JM_CB_ADDRESSOF(_buffer[i]._value)) T(value);
+          detail::construct_at(JM_CB_ADDRESSOF(_buffer[i]._value), value);
       else
         _head = 1;
     }
 
     template<typename InputIt>
-    static_circular_buffer(InputIt first, InputIt last)
-      : _head(0), _tail(0), _size(0), _buffer()
+    JM_CB_CXX20_CONSTEXPR static_circular_buffer(InputIt first, InputIt last)
+      : _head(0), _tail(0), _size(0)
     {
+      _buffer.activate();
       if (first != last) {
         for (; first != last; ++first, ++_size) {
           if (JM_CB_UNLIKELY(_size >= N))
             throw std::out_of_range(
               "static_circular_buffer<T, N>(InputIt first, InputIt last) distance exceeded N");
 
-          new(JM_CB_ADDRESSOF(_buffer[_size]._value)) T(*first);
+          detail::construct_at(JM_CB_ADDRESSOF(_buffer[_size]._value), *first);
         }
 
         _tail = _size - 1;
@@ -89,8 +131,8 @@ namespace jm {
         _head = 1;
     }
 
-    static_circular_buffer(std::initializer_list<T> init)
-      : _head(0), _tail(init.size() - 1), _size(init.size()), _buffer()
+    JM_CB_CXX20_CONSTEXPR static_circular_buffer(std::initializer_list<T> init)
+      : _head(0), _tail(init.size() - 1), _size(init.size())
     {
       if (JM_CB_UNLIKELY(_size > N))
         throw std::out_of_range(
@@ -100,37 +142,38 @@ namespace jm {
       if (JM_CB_UNLIKELY(_size == 0))
         _head = 1;
 
-      auto buf_ptr = _buffer.begin();
+      _buffer.activate();
+      auto buf_ptr = _buffer.data();
       for (auto it = init.begin(), end = init.end(); it != end; ++it, ++buf_ptr)
-        new(JM_CB_ADDRESSOF(buf_ptr->_value)) T(*it);
+        detail::construct_at(JM_CB_ADDRESSOF(buf_ptr->_value), *it);
     }
 
-    static_circular_buffer(const static_circular_buffer& other)
-      : _head(1), _tail(0), _size(0), _buffer()
+    JM_CB_CXX20_CONSTEXPR static_circular_buffer(const static_circular_buffer& other)
+      : _head(1), _tail(0), _size(0)
     {
       copy_buffer(other);
     }
 
-    static_circular_buffer& operator=(const static_circular_buffer& other)
+    JM_CB_CXX20_CONSTEXPR static_circular_buffer& operator=(const static_circular_buffer& other)
     {
       clear();
       copy_buffer(other);
       return *this;
     }
 
-    static_circular_buffer(static_circular_buffer&& other) : _head(1), _tail(0), _size(0), _buffer()
+    JM_CB_CXX20_CONSTEXPR static_circular_buffer(static_circular_buffer&& other) : _head(1), _tail(0), _size(0)
     {
       move_buffer(std::move(other));
     }
 
-    static_circular_buffer& operator=(static_circular_buffer&& other)
+    JM_CB_CXX20_CONSTEXPR static_circular_buffer& operator=(static_circular_buffer&& other)
     {
       clear();
       move_buffer(std::move(other));
       return *this;
     }
 
-    ~static_circular_buffer() { clear(); }
+    JM_CB_CXX20_CONSTEXPR ~static_circular_buffer() { clear(); }
 
     /// capacity
     JM_CB_CONSTEXPR bool empty() const JM_CB_NOEXCEPT { return _size == 0; }
@@ -141,6 +184,8 @@ namespace jm {
 
     JM_CB_CONSTEXPR size_type max_size() const JM_CB_NOEXCEPT { return N; }
 
+    JM_CB_CONSTEXPR const Stats& stats() const JM_CB_NOEXCEPT { return *this; }
+
     /// element access
     JM_CB_CXX14_CONSTEXPR reference front() JM_CB_NOEXCEPT
     {
@@ -166,6 +211,33 @@ namespace jm {
       return _buffer[_tail]._value;
     }
 
+    // i-th element counting from front()
+    JM_CB_CXX14_CONSTEXPR reference operator[](size_type i) JM_CB_NOEXCEPT
+    {
+      JM_ASSERT(i < _size, "index out of range");
+      return _buffer[wrapper_t::advance(_head, i)]._value;
+    }
+
+    JM_CB_CONSTEXPR const_reference operator[](size_type i) const JM_CB_NOEXCEPT
+    {
+      JM_ASSERT(i < _size, "index out of range");
+      return _buffer[wrapper_t::advance(_head, i)]._value;
+    }
+
+    JM_CB_CXX14_CONSTEXPR reference at(size_type i)
+    {
+      if (JM_CB_UNLIKELY(i >= _size))
+        throw std::out_of_range("static_circular_buffer<T, N>::at(size_type) index out of range");
+      return _buffer[wrapper_t::advance(_head, i)]._value;
+    }
+
+    JM_CB_CXX14_CONSTEXPR const_reference at(size_type i) const
+    {
+      if (JM_CB_UNLIKELY(i >= _size))
+        throw std::out_of_range("static_circular_buffer<T, N>::at(size_type) index out of range");
+      return _buffer[wrapper_t::advance(_head, i)]._value;
+    }
+
     JM_CB_CXX14_CONSTEXPR pointer data() JM_CB_NOEXCEPT
     {
       JM_ASSERT(!empty(), "There are empty buffer");
@@ -178,11 +250,56 @@ namespace jm {
       return JM_CB_ADDRESSOF(_buffer[0]._value);
     }
 
+    /// contiguous segments, array_one() holds the oldest elements
+    JM_CB_CXX14_CONSTEXPR array_range array_one() JM_CB_NOEXCEPT
+    {
+      if (_size == 0)
+        return array_range(JM_CB_ADDRESSOF(_buffer[0]._value), 0);
+      return array_range(JM_CB_ADDRESSOF(_buffer[_head]._value), std::min(_size, N - _head));
+    }
+
+    JM_CB_CXX14_CONSTEXPR const_array_range array_one() const JM_CB_NOEXCEPT
+    {
+      if (_size == 0)
+        return const_array_range(JM_CB_ADDRESSOF(_buffer[0]._value), 0);
+      return const_array_range(JM_CB_ADDRESSOF(_buffer[_head]._value), std::min(_size, N - _head));
+    }
+
+    JM_CB_CXX14_CONSTEXPR array_range array_two() JM_CB_NOEXCEPT
+    {
+      return array_range(JM_CB_ADDRESSOF(_buffer[0]._value), _size - array_one().second);
+    }
+
+    JM_CB_CXX14_CONSTEXPR const_array_range array_two() const JM_CB_NOEXCEPT
+    {
+      return const_array_range(JM_CB_ADDRESSOF(_buffer[0]._value), _size - array_one().second);
+    }
+
+    /// free space after back(), written in place and published with commit_back()
+    JM_CB_CXX14_CONSTEXPR array_range free_array_one() JM_CB_NOEXCEPT
+    {
+      const size_type first = wrapper_t::increment(_tail);
+      return array_range(JM_CB_ADDRESSOF(_buffer[first]._value), std::min(N - _size, N - first));
+    }
+
+    JM_CB_CXX14_CONSTEXPR array_range free_array_two() JM_CB_NOEXCEPT
+    {
+      return array_range(JM_CB_ADDRESSOF(_buffer[0]._value), N - _size - free_array_one().second);
+    }
+
     /// modifiers
-    void push_back(const value_type& value)
+    // push_* and emplace_* return false only when the buffer is full and Overflow is
+    // overflow::reject
+    JM_CB_CXX20_CONSTEXPR bool push_back(const value_type& value)
     {
+      activate_slots_if_empty();
       size_type new_tail;
       if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == N)) {
+        if constexpr (!overflow_traits::overwrites) {
+          Stats::on_drop();
+          return overflow_traits::refuse("static_circular_buffer<T, N>::push_back buffer is full");
+        }
+        Stats::on_overwrite();
         new_tail = _head;
         _head = wrapper_t::increment(_head);
         --_size;
@@ -190,17 +307,25 @@ namespace jm {
       }
       else {
         new_tail = wrapper_t::increment(_tail);
-        new(JM_CB_ADDRESSOF(_buffer[new_tail]._value)) T(value);
+        detail::construct_at(JM_CB_ADDRESSOF(_buffer[new_tail]._value), value);
       }
 
       _tail = new_tail;
       ++_size;
+      Stats::on_push(1, _size, N);
+      return true;
     }
 
-    void push_front(const value_type& value)
+    JM_CB_CXX20_CONSTEXPR bool push_front(const value_type& value)
     {
+      activate_slots_if_empty();
       size_type new_head = 0;
       if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == N)) {
+        if constexpr (!overflow_traits::overwrites) {
+          Stats::on_drop();
+          return overflow_traits::refuse("static_circular_buffer<T, N>::push_front buffer is full");
+        }
+        Stats::on_overwrite();
         new_head = _tail;
         _tail = wrapper_t::decrement(_tail);
         --_size;
@@ -208,17 +333,25 @@ namespace jm {
       }
       else {
         new_head = wrapper_t::decrement(_head);
-        new(JM_CB_ADDRESSOF(_buffer[new_head]._value)) T(value);
+        detail::construct_at(JM_CB_ADDRESSOF(_buffer[new_head]._value), value);
       }
 
       _head = new_head;
       ++_size;
+      Stats::on_push(1, _size, N);
+      return true;
     }
 
-    void push_back(value_type&& value)
+    JM_CB_CXX20_CONSTEXPR bool push_back(value_type&& value)
     {
+      activate_slots_if_empty();
       size_type new_tail;
       if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == N)) {
+        if constexpr (!overflow_traits::overwrites) {
+          Stats::on_drop();
+          return overflow_traits::refuse("static_circular_buffer<T, N>::push_back buffer is full");
+        }
+        Stats::on_overwrite();
         new_tail = _head;
         _head = wrapper_t::increment(_head);
         --_size;
@@ -226,18 +359,25 @@ namespace jm {
       }
       else {
         new_tail = wrapper_t::increment(_tail);
-        new(JM_CB_ADDRESSOF(_buffer[new_tail]._value))
-          T(std::move_if_noexcept(value));
+        detail::construct_at(JM_CB_ADDRESSOF(_buffer[new_tail]._value), std::move_if_noexcept(value));
       }
 
       _tail = new_tail;
       ++_size;
+      Stats::on_push(1, _size, N);
+      return true;
     }
 
-    void push_front(value_type&& value)
+    JM_CB_CXX20_CONSTEXPR bool push_front(value_type&& value)
     {
+      activate_slots_if_empty();
       size_type new_head = 0;
       if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == N)) {
+        if constexpr (!overflow_traits::overwrites) {
+          Stats::on_drop();
+          return overflow_traits::refuse("static_circular_buffer<T, N>::push_front buffer is full");
+        }
+        Stats::on_overwrite();
         new_head = _tail;
         _tail = wrapper_t::decrement(_tail);
         --_size;
@@ -245,19 +385,26 @@ namespace jm {
       }
       else {
         new_head = wrapper_t::decrement(_head);
-        new(JM_CB_ADDRESSOF(_buffer[new_head]._value))
-          T(std::move_if_noexcept(value));
+        detail::construct_at(JM_CB_ADDRESSOF(_buffer[new_head]._value), std::move_if_noexcept(value));
       }
 
       _head = new_head;
       ++_size;
+      Stats::on_push(1, _size, N);
+      return true;
     }
 
     template<typename... Args>
-    void emplace_back(Args&&... args)
+    JM_CB_CXX20_CONSTEXPR bool emplace_back(Args&&... args)
     {
+      activate_slots_if_empty();
       size_type new_tail;
       if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == N)) {
+        if constexpr (!overflow_traits::overwrites) {
+          Stats::on_drop();
+          return overflow_traits::refuse("static_circular_buffer<T, N>::emplace_back buffer is full");
+        }
+        Stats::on_overwrite();
         new_tail = _head;
         _head = wrapper_t::increment(_head);
         --_size;
@@ -266,17 +413,24 @@ namespace jm {
       else
         new_tail = wrapper_t::increment(_tail);
 
-      new(JM_CB_ADDRESSOF(_buffer[new_tail]._value))
-        value_type(std::forward<Args>(args)...);
+      detail::construct_at(JM_CB_ADDRESSOF(_buffer[new_tail]._value), std::forward<Args>(args)...);
       _tail = new_tail;
       ++_size;
+      Stats::on_push(1, _size, N);
+      return true;
     }
 
     template<typename... Args>
-    void emplace_front(Args&&... args)
+    JM_CB_CXX20_CONSTEXPR bool emplace_front(Args&&... args)
     {
+      activate_slots_if_empty();
       size_type new_head;
       if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == N)) {
+        if constexpr (!overflow_traits::overwrites) {
+          Stats::on_drop();
+          return overflow_traits::refuse("static_circular_buffer<T, N>::emplace_front buffer is full");
+        }
+        Stats::on_overwrite();
         new_head = _tail;
         _tail = wrapper_t::decrement(_tail);
         --_size;
@@ -285,10 +439,59 @@ namespace jm {
       else
         new_head = wrapper_t::decrement(_head);
 
-      new(JM_CB_ADDRESSOF(_buffer[new_head]._value))
-        value_type(std::forward<Args>(args)...);
+      detail::construct_at(JM_CB_ADDRESSOF(_buffer[new_head]._value), std::forward<Args>(args)...);
+      _head = new_head;
+      ++_size;
+      Stats::on_push(1, _size, N);
+      return true;
+    }
+
+    // Appends a slot and returns its object for the caller to overwrite. When the
+    // buffer is full this is the evicted oldest element, still alive with its
+    // allocations, otherwise a value initialized T.
+    JM_CB_CXX20_CONSTEXPR reference recycle_back()
+    {
+      activate_slots_if_empty();
+      static_assert(overflow_traits::overwrites, "recycling replaces the oldest element");
+      size_type new_tail;
+      if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == N)) {
+        Stats::on_overwrite();
+        new_tail = _head;
+        _head = wrapper_t::increment(_head);
+        --_size;
+      }
+      else {
+        new_tail = wrapper_t::increment(_tail);
+        detail::construct_at(JM_CB_ADDRESSOF(_buffer[new_tail]._value));
+      }
+
+      _tail = new_tail;
+      ++_size;
+      Stats::on_push(1, _size, N);
+      return _buffer[new_tail]._value;
+    }
+
+    // recycle_back() at the front, evicting the newest element when full
+    JM_CB_CXX20_CONSTEXPR reference recycle_front()
+    {
+      activate_slots_if_empty();
+      static_assert(overflow_traits::overwrites, "recycling replaces the oldest element");
+      size_type new_head;
+      if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == N)) {
+        Stats::on_overwrite();
+        new_head = _tail;
+        _tail = wrapper_t::decrement(_tail);
+        --_size;
+      }
+      else {
+        new_head = wrapper_t::decrement(_head);
+        detail::construct_at(JM_CB_ADDRESSOF(_buffer[new_head]._value));
+      }
+
       _head = new_head;
       ++_size;
+      Stats::on_push(1, _size, N);
+      return _buffer[new_head]._value;
     }
 
     JM_CB_CXX14_CONSTEXPR void pop_back() JM_CB_NOEXCEPT
@@ -298,6 +501,7 @@ namespace jm {
       --_size;
       _tail = wrapper_t::decrement(_tail);
       destroy(old_tail);
+      Stats::on_pop(1);
     }
 
     JM_CB_CXX14_CONSTEXPR void pop_front() JM_CB_NOEXCEPT
@@ -307,6 +511,226 @@ namespace jm {
       --_size;
       _head = wrapper_t::increment(_head);
       destroy(old_head);
+      Stats::on_pop(1);
+    }
+
+    // appends the first n free slots, written through free_array_one() / free_array_two()
+    JM_CB_CXX14_CONSTEXPR void commit_back(size_type n) JM_CB_NOEXCEPT
+    {
+      static_assert(std::is_trivially_copyable<T>::value,
+                    "free slots hold no objects, only trivially copyable types can be written to them");
+      JM_ASSERT(n <= N - _size, "commit exceeds the free space");
+      if (n == 0)
+        return;
+      _tail = wrapper_t::advance(_tail, n);
+      _size += n;
+      Stats::on_push(n, _size, N);
+    }
+
+    // Appends gen(0), ..., gen(n - 1), constructed in place one free segment at a time.
+    // When they do not fit, the overflow policy applies to the whole batch: the oldest
+    // elements are overwritten ( and only the last N are generated ), those that do
+    // not fit are rejected, or std::length_error is thrown before anything changes.
+    // Returns the number of elements appended.
+    template<typename Generator>
+    JM_CB_CXX20_CONSTEXPR size_type generate_back(size_type n, Generator gen)
+    {
+      activate_slots_if_empty();
+      size_type first = 0;
+      if (JM_CB_UNLIKELY(n > N - _size)) {
+        if constexpr (overflow_traits::overwrites) {
+          if (n > N)
+            first = n - N;
+          const size_type evicted = n - first - (N - _size);
+          for (size_type i = 0; i < evicted; ++i) {
+            destroy(wrapper_t::advance(_head, i));
+            Stats::on_overwrite();
+          }
+          _head = wrapper_t::advance(_head, evicted);
+          _size -= evicted;
+        }
+        else {
+          for (size_type i = N - _size; i < n; ++i)
+            Stats::on_drop();
+          overflow_traits::refuse("static_circular_buffer<T, N>::generate_back buffer is full");
+          n = N - _size;
+        }
+      }
+
+      // elements must be owned as soon as they exist when they have to be destroyed
+      if constexpr (!JM_CB_IS_TRIVIALLY_DESTRUCTIBLE(T)) {
+        for (size_type i = first; i < n; ++i)
+          emplace_back(gen(i));
+        return n - first;
+      }
+
+      const size_type count = n - first;
+      if (count == 0)
+        return 0;
+
+      const size_type start = wrapper_t::increment(_tail);
+      const size_type in_one = std::min(count, N - start);
+      for (size_type i = 0; i < in_one; ++i)
+        detail::construct_at(JM_CB_ADDRESSOF(_buffer[start + i]._value), gen(first + i));
+
+      for (size_type i = in_one; i < count; ++i)
+        detail::construct_at(JM_CB_ADDRESSOF(_buffer[i - in_one]._value), gen(first + i));
+
+      _tail = wrapper_t::advance(_tail, count);
+      _size += count;
+      Stats::on_push(count, _size, N);
+      return count;
+    }
+
+    // pops the n oldest elements
+    JM_CB_CXX14_CONSTEXPR void erase_begin(size_type n) JM_CB_NOEXCEPT
+    {
+      JM_ASSERT(n <= _size, "erase exceeds the size");
+      if constexpr (!JM_CB_IS_TRIVIALLY_DESTRUCTIBLE(T)) {
+        const size_type in_one = std::min(n, N - _head);
+        for (size_type i = _head; i < _head + in_one; ++i)
+          destroy(i);
+        for (size_type i = 0; i < n - in_one; ++i)
+          destroy(i);
+      }
+      _head = wrapper_t::advance(_head, n);
+      _size -= n;
+      Stats::on_pop(n);
+    }
+
+    // Calls f(element) in place on up to max of the oldest elements, one contiguous
+    // segment after the other, then pops them together with erase_begin(). Elements f
+    // returned from are popped even when a later call throws. Returns the number of
+    // elements consumed.
+    template<typename F>
+    JM_CB_CXX20_CONSTEXPR size_type consume(F f, size_type max = std::numeric_limits<size_type>::max())
+    {
+      consume_guard   guard{ *this, 0 };
+      const size_type in_one = std::min({ _size, N - _head, max });
+      for (size_type i = _head; i < _head + in_one; ++i) {
+        f(_buffer[i]._value);
+        ++guard.count;
+      }
+
+      const size_type in_two = std::min(_size - in_one, max - in_one);
+      for (size_type i = 0; i < in_two; ++i) {
+        f(_buffer[i]._value);
+        ++guard.count;
+      }
+      return guard.count;
+    }
+
+    // Calls f(pointer, size_type) on each non empty contiguous segment, oldest first,
+    // then pops everything. Returns the number of elements consumed.
+    template<typename F>
+    JM_CB_CXX20_CONSTEXPR size_type consume_segments(F f)
+    {
+      consume_guard     guard{ *this, 0 };
+      const array_range segments[2] = { array_one(), array_two() };
+      for (const array_range& segment : segments)
+        if (segment.second != 0) {
+          f(segment.first, segment.second);
+          guard.count += segment.second;
+        }
+      return guard.count;
+    }
+
+    // Inserts before pos by shifting the shorter side, the elements before pos toward
+    // the head or those after it toward the tail, so at most min(k, size() - k)
+    // elements move for pos at index k, segment-wise with memmove when T is trivially
+    // copyable. When full the overflow policy applies: overwrite evicts the oldest
+    // element, or the new one when it would be the oldest. Returns an iterator to the
+    // new element, end() when it was rejected.
+    template<typename... Args>
+    JM_CB_CXX20_CONSTEXPR iterator emplace(const_iterator pos, Args&&... args)
+    {
+      activate_slots_if_empty();
+      size_type k = _size - pos.left_in_forward();
+      // built first, args may refer to an element that is about to move
+      value_type value(std::forward<Args>(args)...);
+      if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_size == N)) {
+        if constexpr (!overflow_traits::overwrites) {
+          Stats::on_drop();
+          overflow_traits::refuse("static_circular_buffer<T, N>::emplace buffer is full");
+          return end();
+        }
+        else {
+          Stats::on_overwrite();
+          if (k == 0)
+            return begin();
+          destroy(_head);
+          _head = wrapper_t::increment(_head);
+          --_size;
+          --k;
+        }
+      }
+
+      if (k < _size - k) {
+        const size_type new_head = wrapper_t::decrement(_head);
+        if (k == 0)
+          detail::construct_at(JM_CB_ADDRESSOF(_buffer[new_head]._value), std::move(value));
+        else {
+          detail::construct_at(JM_CB_ADDRESSOF(_buffer[new_head]._value), std::move(_buffer[_head]._value));
+          detail::ring_move(_buffer, wrapper_t::increment(_head), _head, k - 1, true);
+          _buffer[wrapper_t::advance(_head, k - 1)]._value = std::move(value);
+        }
+        _head = new_head;
+      }
+      else {
+        const size_type new_tail = wrapper_t::increment(_tail);
+        if (k == _size)
+          detail::construct_at(JM_CB_ADDRESSOF(_buffer[new_tail]._value), std::move(value));
+        else {
+          detail::construct_at(JM_CB_ADDRESSOF(_buffer[new_tail]._value), std::move(_buffer[_tail]._value));
+          detail::ring_move(_buffer, wrapper_t::advance(_head, k), wrapper_t::advance(_head, k + 1), _size - 1 - k,
+                            false);
+          _buffer[wrapper_t::advance(_head, k)]._value = std::move(value);
+        }
+        _tail = new_tail;
+      }
+
+      ++_size;
+      Stats::on_push(1, _size, N);
+      return iterator_at(k);
+    }
+
+    JM_CB_CXX20_CONSTEXPR iterator insert(const_iterator pos, const value_type& value) { return emplace(pos, value); }
+
+    JM_CB_CXX20_CONSTEXPR iterator insert(const_iterator pos, value_type&& value) { return emplace(pos, std::move(value)); }
+
+    // Erases [first, last) by shifting the shorter side over the gap, at most
+    // min(k, size() - k - m) elements for m elements erased at index k. Returns an
+    // iterator to the element that followed the erased ones.
+    JM_CB_CXX20_CONSTEXPR iterator erase(const_iterator first, const_iterator last)
+    {
+      const size_type k = _size - first.left_in_forward();
+      const size_type m = first.left_in_forward() - last.left_in_forward();
+      if (m == 0)
+        return iterator_at(k);
+
+      if (k < _size - k - m) {
+        detail::ring_move(_buffer, _head, wrapper_t::advance(_head, m), k, false);
+        for (size_type i = 0; i < m; ++i)
+          destroy(wrapper_t::advance(_head, i));
+        _head = wrapper_t::advance(_head, m);
+      }
+      else {
+        detail::ring_move(_buffer, wrapper_t::advance(_head, k + m), wrapper_t::advance(_head, k),
+                          _size - k - m, true);
+        for (size_type i = _size - m; i < _size; ++i)
+          destroy(wrapper_t::advance(_head, i));
+        _tail = wrapper_t::advance(_tail, N - m);
+      }
+
+      _size -= m;
+      Stats::on_pop(m);
+      return iterator_at(k);
+    }
+
+    JM_CB_CXX20_CONSTEXPR iterator erase(const_iterator pos)
+    {
+      const_iterator next = pos;
+      return erase(pos, ++next);
     }
 
     JM_CB_CXX14_CONSTEXPR void clear() JM_CB_NOEXCEPT
@@ -0,0 +1,77 @@
+#ifndef JM_STATS_REGISTRY_HPP
+#define JM_STATS_REGISTRY_HPP
+
+#include <circular_buffer/buffer_stats.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace jm {
+  // Named stats of many buffers using basic_buffer_stats, collected together by a
+  // scraper thread. A buffer must be removed before it is destroyed.
+  class stats_registry {
+  public:
+    struct entry {
+      std::string         name;
+      buffer_stats_values values;
+    };
+
+  private:
+    struct source {
+      std::string                           name;
+      const void*                           stats;
+      std::function<buffer_stats_values()> snapshot;
+    };
+
+    mutable std::mutex  _mutex;
+    std::vector<source> _sources;
+
+  public:
+    template<class Buffer>
+    void add(std::string name, const Buffer& buffer)
+    {
+      const auto*                 stats = &buffer.stats();
+      std::lock_guard<std::mutex> lock(_mutex);
+      _sources.push_back(source{ std::move(name), stats, [stats] { return stats->snapshot(); } });
+    }
+
+    template<class Buffer>
+    void remove(const Buffer& buffer)
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      const void*                 stats = &buffer.stats();
+      _sources.erase(std::remove_if(_sources.begin(), _sources.end(),
+                                    [stats](const source& s) { return s.stats == stats; }),
+                     _sources.end());
+    }
+
+    std::vector<entry> collect() const
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      std::vector<entry>          entries;
+      entries.reserve(_sources.size());
+      for (const source& s : _sources)
+        entries.push_back(entry{ s.name, s.snapshot() });
+      return entries;
+    }
+
+    // one "name counter value" line per counter
+    void write_text(std::ostream& os) const
+    {
+      for (const entry& e : collect()) {
+        os << e.name << " pushes " << e.values.pushes << '\n'
+           << e.name << " pops " << e.values.pops << '\n'
+           << e.name << " overwrites " << e.values.overwrites << '\n'
+           << e.name << " drops " << e.values.drops << '\n'
+           << e.name << " high_water_mark " << e.values.high_water_mark << '\n'
+           << e.name << " full_ns " << e.values.full_ns << '\n';
+      }
+    }
+  };
+} // namespace jm
+
+#endif // JM_STATS_REGISTRY_HPP
@@ -0,0 +1,114 @@
+#ifndef JM_TIME_WINDOW_BUFFER_HPP
+#define JM_TIME_WINDOW_BUFFER_HPP
+
+#include <circular_buffer/dynamic_circular_buffer.hpp>
+
+#include <chrono>
+
+namespace jm {
+  // Timestamped events evicted by age instead of by count. Entries are kept in a
+  // dynamic_circular_buffer ordered by their ( non decreasing ) timestamps, so a time
+  // range is found by binary search in the two storage segments and returned as views
+  // into them. The ring only grows when live entries do not fit, i.e. on rate spikes.
+  template<typename T, typename Timestamp = std::chrono::steady_clock::time_point>
+  class time_window_buffer {
+  public:
+    typedef T                                                                  value_type;
+    typedef Timestamp                                                          time_type;
+    typedef decltype(std::declval<Timestamp>() - std::declval<Timestamp>()) duration_type;
+    typedef std::size_t                                                        size_type;
+
+    struct entry {
+      Timestamp time;
+      T         value;
+    };
+
+    typedef dynamic_circular_buffer<entry, std::allocator<entry>, overflow::grow> buffer_type;
+    typedef typename buffer_type::const_array_range                              const_array_range;
+
+    // entries of a time range, oldest first: one, then two
+    struct range_view {
+      const_array_range one;
+      const_array_range two;
+
+      size_type size() const JM_CB_NOEXCEPT { return one.second + two.second; }
+
+      bool empty() const JM_CB_NOEXCEPT { return size() == 0; }
+    };
+
+  private:
+    buffer_type   _entries;
+    duration_type _window;
+
+    // logical index of the first entry not older than t
+    size_type lower_index(const Timestamp& t) const
+    {
+      const auto one = _entries.array_one();
+      const auto two = _entries.array_two();
+      const auto older = [](const entry& e, const Timestamp& value) { return e.time < value; };
+
+      if (two.second == 0 || !older(two.first[0], t))
+        return static_cast<size_type>(std::lower_bound(one.first, one.first + one.second, t, older) - one.first);
+      return one.second +
+             static_cast<size_type>(std::lower_bound(two.first, two.first + two.second, t, older) - two.first);
+    }
+
+  public:
+    explicit time_window_buffer(duration_type window, size_type initial_capacity = 64)
+      : _entries(initial_capacity), _window(window)
+    {}
+
+    /// capacity
+    bool empty() const JM_CB_NOEXCEPT { return _entries.empty(); }
+
+    size_type size() const JM_CB_NOEXCEPT { return _entries.size(); }
+
+    size_type capacity() const JM_CB_NOEXCEPT { return _entries.max_size(); }
+
+    duration_type window() const JM_CB_NOEXCEPT { return _window; }
+
+    /// element access
+    const buffer_type& buffer() const JM_CB_NOEXCEPT { return _entries; }
+
+    const entry& front() const JM_CB_NOEXCEPT { return _entries.front(); }
+
+    const entry& back() const JM_CB_NOEXCEPT { return _entries.back(); }
+
+    // entries with t0 <= time < t1, without copying
+    range_view range(const Timestamp& t0, const Timestamp& t1) const
+    {
+      const auto      one = _entries.array_one();
+      const auto      two = _entries.array_two();
+      const size_type first = lower_index(t0);
+      const size_type last = std::max(first, lower_index(t1));
+
+      range_view view;
+      view.one = const_array_range(one.first + std::min(first, one.second),
+                                   std::min(last, one.second) - std::min(first, one.second));
+      view.two = const_array_range(two.first + (std::max(first, one.second) - one.second),
+                                   std::max(last, one.second) - std::max(first, one.second));
+      return view;
+    }
+
+    /// modifiers
+    // appends an event, timestamps must not decrease
+    void push(const Timestamp& time, const value_type& value)
+    {
+      JM_ASSERT(empty() || !(time < _entries.back().time), "timestamps must not decrease");
+      evict_expired(time);
+      // a full ring doubles, moving each entry once
+      _entries.push_back(entry{ time, value });
+    }
+
+    // drops every entry whose age at now reached the window
+    void evict_expired(const Timestamp& now)
+    {
+      while (!_entries.empty() && !(now - _entries.front().time < _window))
+        _entries.pop_front();
+    }
+
+    void clear() { _entries.clear(); }
+  };
+} // namespace jm
+
+#endif // JM_TIME_WINDOW_BUFFER_HPP
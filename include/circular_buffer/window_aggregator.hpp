@@ -0,0 +1,112 @@
+#ifndef JM_WINDOW_AGGREGATOR_HPP
+#define JM_WINDOW_AGGREGATOR_HPP
+
+#include <circular_buffer/static_circular_buffer.hpp>
+#include <circular_buffer/dynamic_circular_buffer.hpp>
+
+namespace jm {
+  // Sliding window aggregation over any associative Op ( two-stacks lite ).
+  // The window is stored in a single Buffer: the oldest _front elements hold
+  // suffix aggregates, the rest hold raw values folded into _back. query() is
+  // O(1), push() / pop() are O(1) amortized. Op does not have to be invertible
+  // or commutative. A dynamic window starts with no capacity and must be
+  // reserve()d before the first push().
+  template<class Buffer, class Op>
+  class window_aggregator {
+  public:
+    typedef Buffer                           buffer_type;
+    typedef typename Buffer::value_type      value_type;
+    typedef typename Buffer::size_type       size_type;
+    typedef typename Buffer::const_reference const_reference;
+
+  private:
+    Buffer     _items;
+    size_type  _front;
+    value_type _back;
+    value_type _identity;
+    Op         _op;
+
+    // turn every stored element into the aggregate of itself and all newer ones
+    void flip()
+    {
+      value_type                      acc = _identity;
+      const typename Buffer::iterator first = _items.begin();
+      for (typename Buffer::iterator it = _items.end(); it != first;) {
+        --it;
+        acc = _op(*it, acc);
+        *it = acc;
+      }
+
+      _front = _items.size();
+      _back = _identity;
+    }
+
+  public:
+    explicit window_aggregator(const value_type& identity = value_type(), const Op& op = Op())
+      : _items(), _front(0), _back(identity), _identity(identity), _op(op)
+    {}
+
+    /// capacity
+    void reserve(size_type window)
+    {
+      _items.reserve(window);
+      clear();
+    }
+
+    bool empty() const JM_CB_NOEXCEPT { return _items.empty(); }
+
+    bool full() const JM_CB_NOEXCEPT { return _items.full(); }
+
+    size_type size() const JM_CB_NOEXCEPT { return _items.size(); }
+
+    size_type max_size() const JM_CB_NOEXCEPT { return _items.max_size(); }
+
+    /// aggregate of every element in the window, oldest first
+    value_type query() const
+    {
+      if (_front == 0)
+        return _back;
+      return _op(_items.front(), _back);
+    }
+
+    /// modifiers
+    // pushes a new element, evicting the oldest one if the window is full
+    void push(const value_type& value)
+    {
+      JM_ASSERT(max_size() != 0, "window has no capacity, reserve() it first");
+      if (JM_CIRCULAR_BUFFER_FULLNESS_LIKEHOOD(_items.full())) {
+        if (_front == 0)
+          flip();
+        --_front;
+      }
+
+      _items.push_back(value);
+      _back = _op(_back, value);
+    }
+
+    void pop()
+    {
+      JM_ASSERT(!empty(), "There are empty buffer");
+      if (_front == 0)
+        flip();
+
+      _items.pop_front();
+      --_front;
+    }
+
+    void clear()
+    {
+      _items.clear();
+      _front = 0;
+      _back = _identity;
+    }
+  };
+
+  template<class T, std::size_t N, class Op>
+  using static_window_aggregator = window_aggregator<static_circular_buffer<T, N>, Op>;
+
+  template<class T, class Op, class Allocator = std::allocator<T>>
+  using dynamic_window_aggregator = window_aggregator<dynamic_circular_buffer<T, Allocator>, Op>;
+} // namespace jm
+
+#endif // JM_WINDOW_AGGREGATOR_HPP
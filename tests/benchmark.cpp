@@ -4,7 +4,17 @@
 
 #include <iostream>
 #include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
 
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
 #include <ctime>
 
 namespace {
@@ -55,6 +65,35 @@ namespace {
     }
   }
 
+  // push_back and generate_back of the same values, range(0) elements per iteration
+  template<class Buffer>
+  void BM_CircleBuffer_k1kB_indexed_push_back(benchmark::State& state) {
+    Buffer data;
+    data.resize(k1kB);
+    for (auto _ : state) {
+      for (size_t i = 0; i < static_cast<size_t>(state.range(0)); i++)
+        data.push_back(static_cast<char>(i));
+      benchmark::DoNotOptimize(data.back());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  template<class Buffer>
+  void BM_CircleBuffer_k1kB_generate_back(benchmark::State& state) {
+    Buffer data;
+    data.resize(k1kB);
+    for (auto _ : state) {
+      data.generate_back(static_cast<size_t>(state.range(0)), [](size_t i) { return static_cast<char>(i); });
+      benchmark::DoNotOptimize(data.back());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  template<std::size_t N>
+  struct resizable_static_char_buffer : jm::static_circular_buffer<char, N> {
+    void resize(std::size_t) {}
+  };
+
   void BM_StaticCircleBufferCreation_k1kB_iteration(benchmark::State& state) {
     jm::static_circular_buffer<char, k1kB> data;
     for (size_t i = 0; i < state.range(0); i++) {
@@ -134,6 +173,1095 @@ void BM_DynamicCircleBufferEigen_1K_elements_with_Allocator(benchmark::State& st
   }
 }
 
+struct max_op {
+  int operator()(int a, int b) const { return std::max(a, b); }
+};
+
+void BM_DynamicWindowAggregator_push_query(benchmark::State& state) {
+  const auto window = static_cast<size_t>(state.range(0));
+  jm::dynamic_window_aggregator<int, max_op> agg(std::numeric_limits<int>::min());
+  agg.reserve(window);
+  for (size_t i = 0; i < window; ++i)
+    agg.push(rand());
+
+  for (auto _ : state) {
+    agg.push(rand());
+    benchmark::DoNotOptimize(agg.query());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_DynamicCircleBuffer_naive_reaggregation(benchmark::State& state) {
+  const auto window = static_cast<size_t>(state.range(0));
+  jm::dynamic_circular_buffer<int> data(window);
+  for (size_t i = 0; i < window; ++i)
+    data.push_back(rand());
+
+  for (auto _ : state) {
+    data.push_back(rand());
+    benchmark::DoNotOptimize(std::accumulate(data.begin(), data.end(), std::numeric_limits<int>::min(), max_op()));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_RangeSumIndex_many_k_per_push(benchmark::State& state) {
+  const auto window = static_cast<size_t>(state.range(0));
+  jm::range_sum_index<double> index(window);
+  for (size_t i = 0; i < window; ++i)
+    index.push_back(rand() / double(RAND_MAX));
+
+  for (auto _ : state) {
+    index.push_back(rand() / double(RAND_MAX));
+    for (size_t k = 1; k <= window; k *= 2)
+      benchmark::DoNotOptimize(index.sum_last(k));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_DynamicCircleBuffer_many_k_naive(benchmark::State& state) {
+  const auto window = static_cast<size_t>(state.range(0));
+  jm::dynamic_circular_buffer<double> data(window);
+  for (size_t i = 0; i < window; ++i)
+    data.push_back(rand() / double(RAND_MAX));
+
+  for (auto _ : state) {
+    data.push_back(rand() / double(RAND_MAX));
+    for (size_t k = 1; k <= window; k *= 2) {
+      auto   it = data.end();
+      double sum = 0.;
+      for (size_t i = 0; i < k; ++i)
+        sum += *--it;
+      benchmark::DoNotOptimize(sum);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_DynamicOrderStatisticsWindow_push_median(benchmark::State& state) {
+  const auto window_size = static_cast<size_t>(state.range(0));
+  jm::dynamic_order_statistics_window<float> window;
+  window.reserve(window_size);
+  for (size_t i = 0; i < window_size; ++i)
+    window.push(static_cast<float>(rand()));
+
+  for (auto _ : state) {
+    window.push(static_cast<float>(rand()));
+    benchmark::DoNotOptimize(window.median());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_DynamicCircleBuffer_copy_nth_element_median(benchmark::State& state) {
+  const auto window_size = static_cast<size_t>(state.range(0));
+  jm::dynamic_circular_buffer<float> data(window_size);
+  std::vector<float>                 scratch(window_size);
+  for (size_t i = 0; i < window_size; ++i)
+    data.push_back(static_cast<float>(rand()));
+
+  for (auto _ : state) {
+    data.push_back(static_cast<float>(rand()));
+    std::copy(data.begin(), data.end(), scratch.begin());
+    std::nth_element(scratch.begin(), scratch.begin() + static_cast<std::ptrdiff_t>(scratch.size() / 2), scratch.end());
+    benchmark::DoNotOptimize(scratch[scratch.size() / 2]);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_FirFilter_block_on_ring(benchmark::State& state) {
+  constexpr size_t kBlock = 256;
+  std::vector<float> taps(static_cast<size_t>(state.range(0)));
+  for (auto& tap : taps)
+    tap = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+
+  jm::fir_filter<float>              filter(taps.begin(), taps.end());
+  jm::dynamic_circular_buffer<float> in(taps.size() + 3 * kBlock);
+  jm::dynamic_circular_buffer<float> out(4 * kBlock);
+  for (size_t i = 0; i < in.max_size(); ++i)
+    in.push_back(static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < kBlock; ++i)
+      in.push_back(static_cast<float>(i));
+    filter.process(in, kBlock, out);
+    benchmark::DoNotOptimize(out.back());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kBlock));
+}
+
+void BM_FirFilter_unwrap_then_filter(benchmark::State& state) {
+  constexpr size_t kBlock = 256;
+  std::vector<float> taps(static_cast<size_t>(state.range(0)));
+  for (auto& tap : taps)
+    tap = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+
+  jm::dynamic_circular_buffer<float> in(taps.size() + 3 * kBlock);
+  jm::dynamic_circular_buffer<float> out(4 * kBlock);
+  std::vector<float>                 scratch(in.max_size());
+  for (size_t i = 0; i < in.max_size(); ++i)
+    in.push_back(static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < kBlock; ++i)
+      in.push_back(static_cast<float>(i));
+    std::copy(in.begin(), in.end(), scratch.begin());
+    const size_t start = scratch.size() - kBlock;
+    for (size_t n = start; n < scratch.size(); ++n) {
+      float y = 0.f;
+      for (size_t k = 0; k < taps.size(); ++k)
+        y += taps[k] * scratch[n - k];
+      out.push_back(y);
+    }
+    benchmark::DoNotOptimize(out.back());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kBlock));
+}
+
+template<class Interpolation>
+void BM_DelayLine_batched_taps(benchmark::State& state) {
+  jm::dynamic_delay_line<float, Interpolation> line;
+  line.reserve(48000);
+  for (size_t i = 0; i < 48000; ++i)
+    line.push(static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
+
+  std::vector<float> delays(static_cast<size_t>(state.range(0))), out(delays.size());
+  for (auto& delay : delays)
+    delay = static_cast<float>(rand()) / static_cast<float>(RAND_MAX) * 4700.f;
+
+  for (auto _ : state) {
+    line.push(static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
+    line.read(delays.data(), out.data(), delays.size());
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class Interpolation>
+void BM_DelayLine_single_taps(benchmark::State& state) {
+  jm::dynamic_delay_line<float, Interpolation> line;
+  line.reserve(48000);
+  for (size_t i = 0; i < 48000; ++i)
+    line.push(static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
+
+  std::vector<float> delays(static_cast<size_t>(state.range(0)));
+  for (auto& delay : delays)
+    delay = static_cast<float>(rand()) / static_cast<float>(RAND_MAX) * 4700.f;
+
+  for (auto _ : state) {
+    line.push(static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
+    for (auto delay : delays)
+      benchmark::DoNotOptimize(line.read(delay));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_TimeWindowBuffer_ingest(benchmark::State& state) {
+  using clock = std::chrono::steady_clock;
+  jm::time_window_buffer<float> events(std::chrono::seconds(5));
+  auto                          now = clock::now();
+
+  for (auto _ : state) {
+    now += std::chrono::microseconds(rand() % 20);
+    events.push(now, 1.f);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_TimeWindowBuffer_range_query(benchmark::State& state) {
+  using clock = std::chrono::steady_clock;
+  jm::time_window_buffer<float> events(std::chrono::seconds(5));
+  const auto                    start = clock::now();
+  auto                          now = start;
+  for (long i = 0; i < state.range(0); ++i) {
+    now += std::chrono::microseconds(5000000 / state.range(0));
+    events.push(now, 1.f);
+  }
+
+  for (auto _ : state) {
+    const auto t0 = start + std::chrono::microseconds(rand() % 5000000);
+    benchmark::DoNotOptimize(events.range(t0, t0 + std::chrono::milliseconds(100)).size());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_CascadingBuffer_ingest(benchmark::State& state) {
+  static jm::cascading_buffer<float, 3600, 60, 3> history; // seconds, minutes, hours
+
+  for (auto _ : state)
+    history.push(static_cast<float>(rand()));
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_CascadingBuffer_summarize_last_hour(benchmark::State& state) {
+  static jm::cascading_buffer<float, 3600, 60, 3> history;
+  for (int i = 0; i < 60 * 3600; ++i)
+    history.push(static_cast<float>(rand()));
+
+  // the same hour read from every level: 3600 seconds, 60 minutes or 1 hour
+  const auto level = static_cast<size_t>(state.range(0));
+  const auto count = size_t(3600) / history.resolution(level);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(history.summarize(level, count));
+  state.SetItemsProcessed(state.iterations());
+}
+
+// slowly drifting sensor sampled every second with a little jitter
+std::pair<std::int64_t, double> sensor_sample(std::int64_t i) {
+  const std::int64_t t = i * 1000 + (i % 16 == 0 ? 3 : 0);
+  const double       v = std::round((20. + std::sin(static_cast<double>(i) / 600.) * 5.) * 10.) / 10.;
+  return { t, v };
+}
+
+void BM_CompressedSeries_encode(benchmark::State& state) {
+  jm::compressed_series<double> series(1 << 12);
+  std::int64_t i = 0;
+
+  for (auto _ : state) {
+    const auto p = sensor_sample(i++);
+    series.push(p.first, p.second);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["ratio"] = double(series.size() * 16) / double(series.compressed_bytes());
+}
+
+void BM_DynamicCircleBuffer_uncompressed_encode(benchmark::State& state) {
+  jm::dynamic_circular_buffer<std::pair<std::int64_t, double>> series(1 << 20);
+  std::int64_t i = 0;
+
+  for (auto _ : state)
+    series.push_back(sensor_sample(i++));
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_CompressedSeries_decode(benchmark::State& state) {
+  jm::compressed_series<double> series(1 << 12);
+  for (std::int64_t i = 0; i < (1 << 20); ++i) {
+    const auto p = sensor_sample(i);
+    series.push(p.first, p.second);
+  }
+
+  for (auto _ : state) {
+    double sum = 0;
+    for (const auto& p : series)
+      sum += p.value;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(series.size()));
+  state.counters["ratio"] = double(series.size() * 16) / double(series.compressed_bytes());
+}
+
+void BM_DynamicCircleBuffer_uncompressed_decode(benchmark::State& state) {
+  jm::dynamic_circular_buffer<std::pair<std::int64_t, double>> series(1 << 20);
+  for (std::int64_t i = 0; i < (1 << 20); ++i)
+    series.push_back(sensor_sample(i));
+
+  for (auto _ : state) {
+    double sum = 0;
+    for (const auto& p : series)
+      sum += p.second;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(series.size()));
+}
+
+void BM_ByteRecordRing_messages(benchmark::State& state) {
+  const auto           size = static_cast<size_t>(state.range(0));
+  jm::byte_record_ring ring(4 * (size + 8));
+  std::vector<char>    message(size, 'x');
+
+  for (auto _ : state) {
+    ring.write(message.data(), message.size());
+    const auto record = ring.read_next();
+    benchmark::DoNotOptimize(record.data[record.size - 1]);
+    ring.release();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+
+void BM_DynamicCircleBuffer_char_messages(benchmark::State& state) {
+  const auto                        size = static_cast<size_t>(state.range(0));
+  jm::dynamic_circular_buffer<char> ring(4 * (size + 8));
+  std::vector<char>                 message(size, 'x');
+  std::vector<char>                 received(size);
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < 8; ++i)
+      ring.push_back(reinterpret_cast<const char*>(&size)[i]);
+    for (char c : message)
+      ring.push_back(c);
+
+    size_t length = 0;
+    for (size_t i = 0; i < 8; ++i) {
+      reinterpret_cast<char*>(&length)[i] = ring.front();
+      ring.pop_front();
+    }
+    for (size_t i = 0; i < length; ++i) {
+      received[i] = ring.front();
+      ring.pop_front();
+    }
+    benchmark::DoNotOptimize(received.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+
+struct draw_command_base {
+  virtual ~draw_command_base() = default;
+  virtual void execute(float& target) = 0;
+};
+
+template<std::size_t Words>
+struct draw_command : draw_command_base {
+  float payload[Words];
+
+  explicit draw_command(float v) { std::fill(payload, payload + Words, v); }
+
+  void execute(float& target) override { target += payload[Words - 1]; }
+
+  void operator()(float& target) const { target += payload[Words - 1]; }
+};
+
+void BM_CommandRing_dispatch(benchmark::State& state) {
+  jm::command_ring<void(float&)> ring(1 << 16);
+  float                          target = 0;
+
+  for (auto _ : state) {
+    for (int i = 0; i < 64; ++i) {
+      if (i % 2)
+        ring.try_emplace<draw_command<4>>(1.f);
+      else
+        ring.try_emplace<draw_command<16>>(2.f);
+    }
+    ring.dispatch_all(target);
+  }
+  benchmark::DoNotOptimize(target);
+  state.SetItemsProcessed(state.iterations() * 64);
+}
+
+void BM_DynamicCircleBuffer_unique_ptr_dispatch(benchmark::State& state) {
+  jm::dynamic_circular_buffer<std::unique_ptr<draw_command_base>> ring(1 << 10);
+  float                                                           target = 0;
+
+  for (auto _ : state) {
+    for (int i = 0; i < 64; ++i) {
+      if (i % 2)
+        ring.push_back(std::unique_ptr<draw_command_base>(new draw_command<4>(1.f)));
+      else
+        ring.push_back(std::unique_ptr<draw_command_base>(new draw_command<16>(2.f)));
+    }
+    while (!ring.empty()) {
+      ring.front()->execute(target);
+      ring.front().reset();
+      ring.pop_front();
+    }
+  }
+  benchmark::DoNotOptimize(target);
+  state.SetItemsProcessed(state.iterations() * 64);
+}
+
+#if defined(__has_include)
+#if __has_include(<sys/uio.h>)
+#define JM_CB_BENCHMARK_POSIX
+#include <circular_buffer/fd_io.hpp>
+#include <unistd.h>
+#endif
+#endif
+
+#ifdef JM_CB_BENCHMARK_POSIX
+// one chunk goes through a pipe per iteration, consumed as soon as it is read
+void BM_DynamicCircleBuffer_pipe_read_from(benchmark::State& state) {
+  const auto                        chunk = static_cast<size_t>(state.range(0));
+  jm::dynamic_circular_buffer<char> ring(64 << 10);
+  std::vector<char>                 data(chunk, 'x');
+  int                               fds[2];
+  if (pipe(fds) != 0)
+    return state.SkipWithError("pipe failed");
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(write(fds[1], data.data(), chunk));
+    benchmark::DoNotOptimize(jm::read_from(fds[0], ring));
+    ring.erase_begin(ring.size());
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(chunk));
+  close(fds[0]);
+  close(fds[1]);
+}
+
+void BM_DynamicCircleBuffer_pipe_read_push_back(benchmark::State& state) {
+  const auto                        chunk = static_cast<size_t>(state.range(0));
+  jm::dynamic_circular_buffer<char> ring(64 << 10);
+  std::vector<char>                 data(chunk, 'x');
+  std::vector<char>                 temp(64 << 10);
+  int                               fds[2];
+  if (pipe(fds) != 0)
+    return state.SkipWithError("pipe failed");
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(write(fds[1], data.data(), chunk));
+    const auto n = read(fds[0], temp.data(), temp.size());
+    for (ssize_t i = 0; i < n; ++i)
+      ring.push_back(temp[static_cast<size_t>(i)]);
+    ring.clear();
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(chunk));
+  close(fds[0]);
+  close(fds[1]);
+}
+#endif
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define JM_CB_BENCHMARK_LINUX
+#include <circular_buffer/async_drain.hpp>
+#include <chrono>
+#endif
+#endif
+
+#ifdef JM_CB_BENCHMARK_LINUX
+// producer appending 4 KB chunks to a 4 MB ring that is archived to a temporary file.
+// stall_ns is the time the producer spends blocked per chunk
+void BM_AsyncDrain_archive(benchmark::State& state) {
+  using drain_type = jm::async_drain<jm::dynamic_circular_buffer<char>>;
+  const auto kind = state.range(0) == 0 ? drain_type::backend::io_uring : drain_type::backend::thread;
+  constexpr size_t chunk = 4 << 10;
+
+  std::FILE*                        file = std::tmpfile();
+  jm::dynamic_circular_buffer<char> ring(4 << 20);
+  std::chrono::nanoseconds          stall(0);
+  try {
+    drain_type drain(ring, fileno(file), 0, 8, 256 << 10, kind);
+    for (auto _ : state) {
+      while (ring.max_size() - ring.size() < chunk) {
+        const auto start = std::chrono::steady_clock::now();
+        drain.wait();
+        stall += std::chrono::steady_clock::now() - start;
+      }
+
+      auto one = ring.free_array_one();
+      auto two = ring.free_array_two();
+      const size_t first = std::min(chunk, one.second);
+      std::fill(one.first, one.first + first, 'x');
+      std::fill(two.first, two.first + (chunk - first), 'y');
+      ring.commit_back(chunk);
+      drain.poll();
+    }
+    drain.flush();
+  }
+  catch (const std::exception& e) {
+    state.SkipWithError(e.what());
+  }
+  std::fclose(file);
+
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(chunk));
+  state.counters["stall_ns"] = static_cast<double>(stall.count()) / static_cast<double>(state.iterations());
+}
+
+void BM_DynamicCircleBuffer_archive_sync_write(benchmark::State& state) {
+  constexpr size_t chunk = 4 << 10;
+
+  std::FILE*                        file = std::tmpfile();
+  jm::dynamic_circular_buffer<char> ring(4 << 20);
+  std::chrono::nanoseconds          stall(0);
+  for (auto _ : state) {
+    auto one = ring.free_array_one();
+    auto two = ring.free_array_two();
+    const size_t first = std::min(chunk, one.second);
+    std::fill(one.first, one.first + first, 'x');
+    std::fill(two.first, two.first + (chunk - first), 'y');
+    ring.commit_back(chunk);
+
+    if (ring.size() >= (256 << 10)) {
+      const auto start = std::chrono::steady_clock::now();
+      while (!ring.empty())
+        jm::write_to(fileno(file), ring);
+      stall += std::chrono::steady_clock::now() - start;
+    }
+  }
+  std::fclose(file);
+
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(chunk));
+  state.counters["stall_ns"] = static_cast<double>(stall.count()) / static_cast<double>(state.iterations());
+}
+#endif
+
+#ifdef JM_CB_BENCHMARK_POSIX
+jm::dynamic_circular_buffer<std::uint64_t> gen_snapshot_buffer(size_t bytes) {
+  jm::dynamic_circular_buffer<std::uint64_t> cb(bytes / sizeof(std::uint64_t));
+  for (size_t i = 0; i < cb.max_size() + cb.max_size() / 3; ++i)
+    cb.push_back(i);
+  return cb;
+}
+
+void BM_Snapshot_save_fd(benchmark::State& state) {
+  const auto cb = gen_snapshot_buffer(static_cast<size_t>(state.range(0)));
+  std::FILE* file = std::tmpfile();
+
+  for (auto _ : state) {
+    lseek(fileno(file), 0, SEEK_SET);
+    jm::save(fileno(file), cb);
+  }
+  std::fclose(file);
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void BM_Snapshot_load_fd(benchmark::State& state) {
+  const auto cb = gen_snapshot_buffer(static_cast<size_t>(state.range(0)));
+  std::FILE* file = std::tmpfile();
+  jm::save(fileno(file), cb);
+
+  jm::dynamic_circular_buffer<std::uint64_t> restored(cb.max_size());
+  for (auto _ : state) {
+    lseek(fileno(file), 0, SEEK_SET);
+    jm::load(fileno(file), restored);
+  }
+  std::fclose(file);
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// what checkpointing looked like before: one stream write per element
+void BM_DynamicCircleBuffer_save_per_element(benchmark::State& state) {
+  const auto cb = gen_snapshot_buffer(static_cast<size_t>(state.range(0)));
+  std::FILE* file = std::tmpfile();
+
+  for (auto _ : state) {
+    std::rewind(file);
+    for (const auto& value : cb)
+      std::fwrite(&value, sizeof(value), 1, file);
+    std::fflush(file);
+  }
+  std::fclose(file);
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+#endif
+
+// a burst of 10x the ring capacity, then the consumer catches up
+void BM_SpillingCircleBuffer_burst_10x(benchmark::State& state) {
+  const auto capacity = static_cast<size_t>(state.range(0));
+  jm::spilling_circular_buffer<std::uint64_t> buffer(capacity);
+  std::uint64_t                               received = 0;
+
+  for (auto _ : state) {
+    for (std::uint64_t i = 0; i < 10 * capacity; ++i)
+      buffer.push_back(i);
+    while (!buffer.empty()) {
+      received += buffer.front();
+      buffer.pop_front();
+    }
+  }
+  benchmark::DoNotOptimize(received);
+  state.SetItemsProcessed(state.iterations() * 10 * static_cast<int64_t>(capacity));
+  state.counters["lost"] = 0;
+}
+
+void BM_DynamicCircleBuffer_burst_10x_overwrite(benchmark::State& state) {
+  const auto capacity = static_cast<size_t>(state.range(0));
+  jm::dynamic_circular_buffer<std::uint64_t> buffer(capacity);
+  std::uint64_t                              received = 0, lost = 0;
+
+  for (auto _ : state) {
+    for (std::uint64_t i = 0; i < 10 * capacity; ++i)
+      buffer.push_back(i);
+    lost += 9 * capacity;
+    while (!buffer.empty()) {
+      received += buffer.front();
+      buffer.pop_front();
+    }
+  }
+  benchmark::DoNotOptimize(received);
+  state.SetItemsProcessed(state.iterations() * 10 * static_cast<int64_t>(capacity));
+  state.counters["lost"] = benchmark::Counter(static_cast<double>(lost), benchmark::Counter::kAvgIterations);
+}
+
+#ifdef JM_CB_BENCHMARK_LINUX
+#include <circular_buffer/lazy_page_allocator.hpp>
+
+double resident_megabytes() {
+  std::FILE*    statm = std::fopen("/proc/self/statm", "r");
+  unsigned long size = 0, resident = 0;
+  if (statm == nullptr || std::fscanf(statm, "%lu %lu", &size, &resident) != 2)
+    resident = 0;
+  if (statm != nullptr)
+    std::fclose(statm);
+  return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) / double(1 << 20);
+}
+
+template<class Buffer>
+void BM_GiantRing_creation(benchmark::State& state) {
+  for (auto _ : state) {
+    Buffer cb(k1GB / sizeof(std::uint64_t));
+    benchmark::DoNotOptimize(cb.max_size());
+    state.counters["rss_MB"] = resident_megabytes();
+  }
+}
+
+// 1 GB ring holding a 16 MB window, reclaiming consumed pages every 4 MB when asked to:
+// without the manual reclaim calls the lazy ring keeps every page the tail has touched
+template<class Buffer, bool Reclaim>
+void BM_GiantRing_sliding_window(benchmark::State& state) {
+  constexpr size_t window = (16 << 20) / sizeof(std::uint64_t);
+  constexpr size_t reclaim_period = (4 << 20) / sizeof(std::uint64_t);
+  Buffer           cb(k1GB / sizeof(std::uint64_t));
+  std::uint64_t    i = 0;
+  double           peak = 0;
+
+  for (auto _ : state) {
+    cb.push_back(i);
+    if (cb.size() > window)
+      cb.pop_front();
+    if (++i % reclaim_period == 0) {
+      if (Reclaim)
+        jm::reclaim_unused_pages(cb);
+      peak = std::max(peak, resident_megabytes());
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["rss_MB"] = resident_megabytes();
+  state.counters["peak_rss_MB"] = std::max(peak, resident_megabytes());
+}
+#endif
+
+#ifdef JM_CB_HAS_COROUTINES
+using ping_channel = jm::channel<int, jm::inline_scheduler>;
+
+jm::detached_task ping(ping_channel& to, ping_channel& from, int64_t rounds) {
+  for (int64_t i = 0; i < rounds; ++i) {
+    co_await to.push(static_cast<int>(i));
+    benchmark::DoNotOptimize(co_await from.pop());
+  }
+}
+
+jm::detached_task pong(ping_channel& from, ping_channel& to, int64_t rounds) {
+  for (int64_t i = 0; i < rounds; ++i) {
+    auto value = co_await from.pop();
+    co_await to.push(*value);
+  }
+}
+
+void BM_CoroutineChannel_ping_pong(benchmark::State& state) {
+  jm::inline_scheduler scheduler;
+  ping_channel         a(scheduler, 1), b(scheduler, 1);
+
+  for (auto _ : state) {
+    jm::spawn(scheduler, ping(a, b, 1000));
+    jm::spawn(scheduler, pong(a, b, 1000));
+    scheduler.run();
+  }
+  state.SetItemsProcessed(state.iterations() * 1000);
+}
+#endif
+
+// the same exchange between two threads over condvar protected rings
+struct locked_ring {
+  std::mutex                       mutex;
+  std::condition_variable          cv;
+  jm::dynamic_circular_buffer<int> items{ 2 };
+
+  void push(int value) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return items.empty(); });
+    items.push_back(value);
+    cv.notify_one();
+  }
+
+  int pop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return !items.empty(); });
+    const int value = items.front();
+    items.pop_front();
+    cv.notify_one();
+    return value;
+  }
+};
+
+void BM_ThreadCondvar_ping_pong(benchmark::State& state) {
+  locked_ring a, b;
+
+  for (auto _ : state) {
+    std::thread pong_thread([&] {
+      for (int i = 0; i < 1000; ++i)
+        b.push(a.pop());
+    });
+    for (int i = 0; i < 1000; ++i) {
+      a.push(i);
+      benchmark::DoNotOptimize(b.pop());
+    }
+    pong_thread.join();
+  }
+  state.SetItemsProcessed(state.iterations() * 1000);
+}
+
+#ifdef JM_CB_BENCHMARK_LINUX
+#include <circular_buffer/eventfd_notifier.hpp>
+
+// wakes the consumer with an eventfd write on every commit
+struct per_message_notifier {
+  int    fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  size_t producer_syscalls = 0;
+  size_t consumer_syscalls = 0;
+
+  ~per_message_notifier() { close(fd); }
+
+  int readable_fd() const { return fd; }
+
+  void ack_readable() {
+    std::uint64_t count;
+    benchmark::DoNotOptimize(read(fd, &count, sizeof(count)));
+    ++consumer_syscalls;
+  }
+
+  size_t syscalls() const { return producer_syscalls + consumer_syscalls; }
+
+  void on_commit() {
+    const std::uint64_t one = 1;
+    benchmark::DoNotOptimize(write(fd, &one, sizeof(one)));
+    ++producer_syscalls;
+  }
+
+  void on_release(size_t) {}
+
+  void on_full() {}
+};
+
+// producer writing bursts of 16 timestamped messages to a consumer thread sleeping in
+// epoll_wait, each burst once the previous one was read. syscalls_per_msg counts the
+// notifier and the waits, latency_us is the mean time from commit to read
+template<class Notifier, class... NotifierArgs>
+void run_notified_pipeline(benchmark::State& state, NotifierArgs... notifier_args) {
+  typedef std::chrono::steady_clock clock;
+  jm::basic_byte_record_ring<true, Notifier> ring(1 << 20, notifier_args...);
+
+  const int   epoll = epoll_create1(EPOLL_CLOEXEC);
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  epoll_ctl(epoll, EPOLL_CTL_ADD, ring.notifier().readable_fd(), &event);
+
+  size_t                   messages = 0, waits = 0;
+  std::chrono::nanoseconds latency(0);
+  std::thread              consumer([&] {
+    for (;;) {
+      epoll_wait(epoll, &event, 1, -1);
+      ++waits;
+      ring.notifier().ack_readable();
+      for (auto r = ring.read_next(); !r.empty(); r = ring.read_next()) {
+        if (r.size == 0)
+          return;
+        clock::time_point sent;
+        std::memcpy(&sent, r.data, sizeof(sent));
+        latency += clock::now() - sent;
+        ++messages;
+        ring.release();
+      }
+    }
+  });
+
+  for (auto _ : state) {
+    for (int i = 0; i < 16; ++i) {
+      const clock::time_point now = clock::now();
+      while (!ring.write(&now, sizeof(now)))
+        std::this_thread::yield();
+    }
+    while (!ring.empty())
+      std::this_thread::yield();
+  }
+  while (!ring.write(nullptr, 0))
+    std::this_thread::yield();
+  consumer.join();
+  close(epoll);
+
+  state.SetItemsProcessed(state.iterations() * 16);
+  state.counters["syscalls_per_msg"] = static_cast<double>(ring.notifier().syscalls() + waits) / static_cast<double>(messages);
+  state.counters["latency_us"] = static_cast<double>(latency.count()) / 1000.0 / static_cast<double>(messages);
+}
+
+void BM_EventfdNotifier_pipeline(benchmark::State& state) {
+  run_notified_pipeline<jm::eventfd_notifier>(state, static_cast<size_t>(state.range(0)),
+                                              std::chrono::nanoseconds(std::chrono::milliseconds(1)));
+}
+
+void BM_PerMessageEventfd_pipeline(benchmark::State& state) {
+  run_notified_pipeline<per_message_notifier>(state);
+}
+#endif
+
+// clear() and 1024 push_back into a buffer of 1024: the not full path of each policy
+template<class Buffer>
+void BM_OverflowPolicy_fill(benchmark::State& state) {
+  Buffer buffer;
+  buffer.resize(1024);
+  for (auto _ : state) {
+    buffer.clear();
+    for (int i = 0; i < 1024; ++i)
+      buffer.push_back(i);
+    benchmark::DoNotOptimize(buffer.back());
+  }
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+template<class T, std::size_t N, class Overflow, class Stats = jm::null_buffer_stats>
+struct resizable_static_buffer : jm::static_circular_buffer<T, N, Overflow, Stats> {
+  void resize(std::size_t) {}
+};
+
+// push_back into a full buffer of 1024: overwrite replaces, reject refuses
+template<class Buffer>
+void BM_OverflowPolicy_full(benchmark::State& state) {
+  Buffer buffer;
+  buffer.resize(1024);
+  for (int i = 0; i < 1024; ++i)
+    buffer.push_back(i);
+  int value = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(buffer.push_back(++value));
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// 1M push_back from an empty buffer, growing by doubling like std::vector
+void BM_DynamicCircleBuffer_grow_push_back(benchmark::State& state) {
+  for (auto _ : state) {
+    jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::grow> buffer;
+    for (int i = 0; i < (1 << 20); ++i)
+      buffer.push_back(i);
+    benchmark::DoNotOptimize(buffer.back());
+  }
+  state.SetItemsProcessed(state.iterations() * (1 << 20));
+}
+
+void BM_StdVector_grow_push_back(benchmark::State& state) {
+  for (auto _ : state) {
+    std::vector<int> buffer;
+    for (int i = 0; i < (1 << 20); ++i)
+      buffer.push_back(i);
+    benchmark::DoNotOptimize(buffer.back());
+  }
+  state.SetItemsProcessed(state.iterations() * (1 << 20));
+}
+
+// one push_back and one pop_front on a ring of 1024 ints holding range(0) of them;
+// at 1024 every push makes it full again, the worst case for the time spent full
+template<class Buffer>
+void BM_BufferStats_push_pop(benchmark::State& state) {
+  Buffer buffer;
+  buffer.resize(1024);
+  int value = 0;
+  for (; value < state.range(0); ++value)
+    buffer.push_back(value);
+  for (auto _ : state) {
+    buffer.push_back(++value);
+    buffer.pop_front();
+    benchmark::DoNotOptimize(buffer.front());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+std::size_t counted_allocations = 0;
+
+template<class T>
+struct counting_allocator : std::allocator<T> {
+  template<class U>
+  struct rebind {
+    typedef counting_allocator<U> other;
+  };
+
+  counting_allocator() = default;
+
+  template<class U>
+  counting_allocator(const counting_allocator<U>&) {}
+
+  T* allocate(std::size_t n) {
+    ++counted_allocations;
+    return std::allocator<T>::allocate(n);
+  }
+};
+
+typedef std::basic_string<char, std::char_traits<char>, counting_allocator<char>> counted_string;
+typedef std::vector<float, counting_allocator<float>>                            counted_vector;
+
+void assign_payload(counted_string& s, int i) { s.assign(64, static_cast<char>('a' + i % 26)); }
+
+void assign_payload(counted_vector& v, int i) { v.assign(64, static_cast<float>(i)); }
+
+// pushes into a full static ring of 256 heap owning elements, by building a new
+// element ( Recycle = false ) or by overwriting the evicted one in place
+template<class Payload, bool Recycle>
+void BM_StaticCircleBuffer_payload_overwrite(benchmark::State& state) {
+  jm::static_circular_buffer<Payload, 256> buffer;
+  int i = 0;
+  for (; i < 256; ++i)
+    assign_payload(buffer.recycle_back(), i);
+
+  counted_allocations = 0;
+  for (auto _ : state) {
+    if (Recycle)
+      assign_payload(buffer.recycle_back(), ++i);
+    else {
+      Payload payload;
+      assign_payload(payload, ++i);
+      buffer.push_back(std::move(payload));
+    }
+    benchmark::DoNotOptimize(buffer.back());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["allocs_per_push"] = static_cast<double>(counted_allocations) / static_cast<double>(state.iterations());
+}
+
+// erases the element at range(1) percent of a wrapped ring of range(0) ints and
+// inserts it back at the same index
+void BM_DynamicCircleBuffer_erase_insert(benchmark::State& state) {
+  const size_t                     n = static_cast<size_t>(state.range(0));
+  const std::ptrdiff_t             k = static_cast<std::ptrdiff_t>(n * static_cast<size_t>(state.range(1)) / 100);
+  jm::dynamic_circular_buffer<int> data(n);
+  for (size_t i = 0; i < n + n / 3; i++)
+    data.push_back(static_cast<int>(i));
+  for (auto _ : state) {
+    auto it = data.erase(std::next(data.cbegin(), k));
+    data.insert(it, 1);
+    benchmark::DoNotOptimize(data.front());
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// the same by copying the ring without, then with, the element
+void BM_DynamicCircleBuffer_rebuild_erase_insert(benchmark::State& state) {
+  const size_t                     n = static_cast<size_t>(state.range(0));
+  const size_t                     k = n * static_cast<size_t>(state.range(1)) / 100;
+  jm::dynamic_circular_buffer<int> data(n);
+  jm::dynamic_circular_buffer<int> rebuilt(n);
+  for (size_t i = 0; i < n + n / 3; i++)
+    data.push_back(static_cast<int>(i));
+  for (auto _ : state) {
+    rebuilt.clear();
+    size_t i = 0;
+    for (auto it = data.begin(); it != data.end(); ++it, ++i)
+      if (i != k)
+        rebuilt.push_back(*it);
+
+    data.clear();
+    i = 0;
+    for (auto it = rebuilt.begin(); it != rebuilt.end(); ++it, ++i) {
+      if (i == k)
+        data.push_back(1);
+      data.push_back(*it);
+    }
+    benchmark::DoNotOptimize(data.front());
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+
+void BM_Deque_erase_insert(benchmark::State& state) {
+  const size_t         n = static_cast<size_t>(state.range(0));
+  const std::ptrdiff_t k = static_cast<std::ptrdiff_t>(n * static_cast<size_t>(state.range(1)) / 100);
+  std::deque<int>      data;
+  for (size_t i = 0; i < n; i++)
+    data.push_back(static_cast<int>(i));
+  for (auto _ : state) {
+    auto it = data.erase(data.begin() + k);
+    data.insert(it, 1);
+    benchmark::DoNotOptimize(data.front());
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// drains range(0) ints per iteration, refilled with commit_back so only the drain
+// is measured
+template<class Buffer>
+void BM_CircleBuffer_front_pop_front_drain(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  Buffer       data;
+  data.resize(4 << 10);
+  for (size_t i = 0; i < (4 << 10) + n / 2; i++) // wrapped
+    data.push_back(static_cast<int>(i));
+  data.erase_begin(data.size());
+  for (auto _ : state) {
+    data.commit_back(n);
+    long sum = 0;
+    while (!data.empty()) {
+      sum += data.front();
+      data.pop_front();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class Buffer>
+void BM_CircleBuffer_consume_drain(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  Buffer       data;
+  data.resize(4 << 10);
+  for (size_t i = 0; i < (4 << 10) + n / 2; i++)
+    data.push_back(static_cast<int>(i));
+  data.erase_begin(data.size());
+  for (auto _ : state) {
+    data.commit_back(n);
+    long sum = 0;
+    data.consume([&sum](int value) { sum += value; });
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class Buffer>
+void BM_CircleBuffer_consume_segments_drain(benchmark::State& state) {
+  const size_t n = static_cast<size_t>(state.range(0));
+  Buffer       data;
+  data.resize(4 << 10);
+  for (size_t i = 0; i < (4 << 10) + n / 2; i++)
+    data.push_back(static_cast<int>(i));
+  data.erase_begin(data.size());
+  for (auto _ : state) {
+    data.commit_back(n);
+    long sum = 0;
+    data.consume_segments([&sum](const int* values, size_t count) { sum = std::accumulate(values, values + count, sum); });
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<std::size_t N>
+struct resizable_static_int_buffer : jm::static_circular_buffer<int, N> {
+  void resize(std::size_t) {}
+};
+
+#ifdef JM_CB_BENCHMARK_POSIX
+#include <sys/resource.h>
+
+long minor_page_faults() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_minflt;
+}
+
+// a static buffer of N bytes constructed in fresh heap memory, too large for the stack
+// beyond 1 MB. page_faults counts the pages touched per iteration, the allocation
+// included
+template<std::size_t N>
+void BM_StaticCircleBufferCreation_fresh_memory(benchmark::State& state) {
+  typedef jm::static_circular_buffer<char, N> buffer;
+  const long                                  faults = minor_page_faults();
+  for (auto _ : state) {
+    buffer* data = new buffer;
+    benchmark::DoNotOptimize(data);
+    delete data;
+  }
+  state.counters["page_faults"] =
+    benchmark::Counter(static_cast<double>(minor_page_faults() - faults), benchmark::Counter::kAvgIterations);
+}
+
+// the same capacity for a dynamic buffer, whose vector value initializes every slot
+template<std::size_t N>
+void BM_DynamicCircleBufferCreation_fresh_memory(benchmark::State& state) {
+  const long faults = minor_page_faults();
+  for (auto _ : state) {
+    jm::dynamic_circular_buffer<char> data(N);
+    benchmark::DoNotOptimize(data.max_size());
+  }
+  state.counters["page_faults"] =
+    benchmark::Counter(static_cast<double>(minor_page_faults() - faults), benchmark::Counter::kAvgIterations);
+}
+#endif
+
 //Register the function as a benchmark
 BENCHMARK(BM_StaticCircleBufferCreation_k1kB);
 BENCHMARK(BM_DynamicCircleBufferCreation_k1kB);
@@ -141,6 +1269,10 @@ BENCHMARK(BM_DynamicCircleBufferCreation_k1MB);
 
 BENCHMARK(BM_StaticCircleBufferCreation_k1kB_push_back)->Arg(8)->Arg(64)->Arg(512)->Arg(1 << 10)->Arg(8 << 10);
 BENCHMARK(BM_DynamicCircleBufferCreation_k1kB_push_back)->Arg(8)->Arg(64)->Arg(512)->Arg(1 << 10)->Arg(8 << 10);
+BENCHMARK_TEMPLATE(BM_CircleBuffer_k1kB_indexed_push_back, resizable_static_char_buffer<k1kB>)->Arg(64)->Arg(512)->Arg(8 << 10);
+BENCHMARK_TEMPLATE(BM_CircleBuffer_k1kB_generate_back, resizable_static_char_buffer<k1kB>)->Arg(64)->Arg(512)->Arg(8 << 10);
+BENCHMARK_TEMPLATE(BM_CircleBuffer_k1kB_indexed_push_back, jm::dynamic_circular_buffer<char>)->Arg(64)->Arg(512)->Arg(8 << 10);
+BENCHMARK_TEMPLATE(BM_CircleBuffer_k1kB_generate_back, jm::dynamic_circular_buffer<char>)->Arg(64)->Arg(512)->Arg(8 << 10);
 
 BENCHMARK(BM_StaticCircleBufferCreation_k1kB_iteration)->Arg(8)->Arg(64)->Arg(512)->Arg(1 << 10)->Arg(8 << 10);
 BENCHMARK(BM_DynamicCircleBufferCreation_k1kB_iteration)->Arg(8)->Arg(64)->Arg(512)->Arg(1 << 10)->Arg(8 << 10);
@@ -152,6 +1284,139 @@ BENCHMARK(BM_STDVectorEigen_1K_elements_without_Allocator)->Arg(8)->Arg(64)->Arg
 BENCHMARK(BM_DynamicCircleBufferEigen_1K_elements_with_Allocator)-> Arg(8)->Arg(64)->Arg(512)->Arg(1 << 10)->Arg(8 << 10);
 BENCHMARK(BM_STDVectorEigen_1K_elements_with_Allocator)->Arg(8)->Arg(64)->Arg(512)->Arg(1 << 10)->Arg(8 << 10);
 
+BENCHMARK(BM_DynamicWindowAggregator_push_query)->RangeMultiplier(16)->Range(64, 1 << 20);
+BENCHMARK(BM_DynamicCircleBuffer_naive_reaggregation)->RangeMultiplier(16)->Range(64, 1 << 20);
+
+BENCHMARK(BM_RangeSumIndex_many_k_per_push)->RangeMultiplier(16)->Range(64, 1 << 20);
+BENCHMARK(BM_DynamicCircleBuffer_many_k_naive)->RangeMultiplier(16)->Range(64, 1 << 20);
+
+BENCHMARK(BM_DynamicOrderStatisticsWindow_push_median)->Arg(1 << 10)->Arg(10 << 10)->Arg(100 << 10);
+BENCHMARK(BM_DynamicCircleBuffer_copy_nth_element_median)->Arg(1 << 10)->Arg(10 << 10)->Arg(100 << 10);
+
+BENCHMARK(BM_FirFilter_block_on_ring)->RangeMultiplier(4)->Range(8, 1024);
+BENCHMARK(BM_FirFilter_unwrap_then_filter)->RangeMultiplier(4)->Range(8, 1024);
+
+BENCHMARK_TEMPLATE(BM_DelayLine_batched_taps, jm::linear_interpolation)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(BM_DelayLine_batched_taps, jm::cubic_interpolation)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(BM_DelayLine_batched_taps, jm::lagrange_interpolation)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(BM_DelayLine_single_taps, jm::linear_interpolation)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(BM_DelayLine_single_taps, jm::cubic_interpolation)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(BM_DelayLine_single_taps, jm::lagrange_interpolation)->Arg(16)->Arg(256);
+
+BENCHMARK(BM_TimeWindowBuffer_ingest);
+BENCHMARK(BM_TimeWindowBuffer_range_query)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+BENCHMARK(BM_CascadingBuffer_ingest);
+BENCHMARK(BM_CascadingBuffer_summarize_last_hour)->DenseRange(0, 2);
+
+
+BENCHMARK(BM_CompressedSeries_encode);
+BENCHMARK(BM_DynamicCircleBuffer_uncompressed_encode);
+BENCHMARK(BM_CompressedSeries_decode);
+BENCHMARK(BM_DynamicCircleBuffer_uncompressed_decode);
+
+
+BENCHMARK(BM_ByteRecordRing_messages)->Arg(64)->Arg(1 << 10)->Arg(16 << 10)->Arg(64 << 10);
+BENCHMARK(BM_DynamicCircleBuffer_char_messages)->Arg(64)->Arg(1 << 10)->Arg(16 << 10)->Arg(64 << 10);
+
+
+BENCHMARK(BM_CommandRing_dispatch);
+BENCHMARK(BM_DynamicCircleBuffer_unique_ptr_dispatch);
+
+
+#ifdef JM_CB_BENCHMARK_POSIX
+BENCHMARK(BM_DynamicCircleBuffer_pipe_read_from)->Arg(512)->Arg(4 << 10)->Arg(32 << 10);
+BENCHMARK(BM_DynamicCircleBuffer_pipe_read_push_back)->Arg(512)->Arg(4 << 10)->Arg(32 << 10);
+#endif
+
+
+#ifdef JM_CB_BENCHMARK_LINUX
+BENCHMARK(BM_AsyncDrain_archive)->Arg(0)->Arg(1)->UseRealTime(); // io_uring, worker thread
+BENCHMARK(BM_DynamicCircleBuffer_archive_sync_write)->UseRealTime();
+#endif
+
+
+#ifdef JM_CB_BENCHMARK_POSIX
+BENCHMARK(BM_Snapshot_save_fd)->Arg(1 << 20)->Arg(100 << 20)->Arg(1 << 30)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Snapshot_load_fd)->Arg(1 << 20)->Arg(100 << 20)->Arg(1 << 30)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_DynamicCircleBuffer_save_per_element)->Arg(1 << 20)->Arg(100 << 20)->Arg(1 << 30)->Unit(benchmark::kMillisecond)->UseRealTime();
+#endif
+
+
+BENCHMARK(BM_SpillingCircleBuffer_burst_10x)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_DynamicCircleBuffer_burst_10x_overwrite)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+#ifdef JM_CB_BENCHMARK_LINUX
+BENCHMARK_TEMPLATE(BM_GiantRing_creation, jm::dynamic_circular_buffer<std::uint64_t>)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_GiantRing_creation, jm::lazy_circular_buffer<std::uint64_t>)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_GiantRing_sliding_window, jm::dynamic_circular_buffer<std::uint64_t>, false);
+BENCHMARK_TEMPLATE(BM_GiantRing_sliding_window, jm::lazy_circular_buffer<std::uint64_t>, false);
+BENCHMARK_TEMPLATE(BM_GiantRing_sliding_window, jm::lazy_circular_buffer<std::uint64_t>, true);
+#endif
+
+
+#ifdef JM_CB_HAS_COROUTINES
+BENCHMARK(BM_CoroutineChannel_ping_pong);
+#endif
+BENCHMARK(BM_ThreadCondvar_ping_pong)->UseRealTime();
+
+
+#ifdef JM_CB_BENCHMARK_LINUX
+BENCHMARK(BM_EventfdNotifier_pipeline)->Arg(1)->Arg(16)->Arg(64)->UseRealTime(); // high watermark
+BENCHMARK(BM_PerMessageEventfd_pipeline)->UseRealTime();
+#endif
+
+
+BENCHMARK_TEMPLATE(BM_OverflowPolicy_fill, resizable_static_buffer<int, 1024, jm::overflow::overwrite>);
+BENCHMARK_TEMPLATE(BM_OverflowPolicy_fill, resizable_static_buffer<int, 1024, jm::overflow::reject>);
+BENCHMARK_TEMPLATE(BM_OverflowPolicy_fill, resizable_static_buffer<int, 1024, jm::overflow::throw_exception>);
+BENCHMARK_TEMPLATE(BM_OverflowPolicy_fill, jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::overwrite>);
+BENCHMARK_TEMPLATE(BM_OverflowPolicy_fill, jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::reject>);
+BENCHMARK_TEMPLATE(BM_OverflowPolicy_fill, jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::throw_exception>);
+BENCHMARK_TEMPLATE(BM_OverflowPolicy_fill, jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::grow>);
+BENCHMARK_TEMPLATE(BM_OverflowPolicy_full, resizable_static_buffer<int, 1024, jm::overflow::overwrite>);
+BENCHMARK_TEMPLATE(BM_OverflowPolicy_full, resizable_static_buffer<int, 1024, jm::overflow::reject>);
+BENCHMARK_TEMPLATE(BM_OverflowPolicy_full, jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::overwrite>);
+BENCHMARK_TEMPLATE(BM_OverflowPolicy_full, jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::reject>);
+BENCHMARK(BM_DynamicCircleBuffer_grow_push_back);
+BENCHMARK(BM_StdVector_grow_push_back);
+
+
+BENCHMARK_TEMPLATE(BM_BufferStats_push_pop, jm::dynamic_circular_buffer<int>)->Arg(512)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_BufferStats_push_pop, jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::overwrite, jm::buffer_stats>)->Arg(512)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_BufferStats_push_pop, resizable_static_buffer<int, 1024, jm::overflow::overwrite>)->Arg(512)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_BufferStats_push_pop, resizable_static_buffer<int, 1024, jm::overflow::overwrite, jm::buffer_stats>)->Arg(512)->Arg(1024);
+#ifdef CLOCK_MONOTONIC_COARSE
+BENCHMARK_TEMPLATE(BM_BufferStats_push_pop, resizable_static_buffer<int, 1024, jm::overflow::overwrite, jm::basic_buffer_stats<jm::coarse_steady_clock>>)->Arg(512)->Arg(1024);
+#endif
+
+
+BENCHMARK_TEMPLATE(BM_StaticCircleBuffer_payload_overwrite, counted_string, false);
+BENCHMARK_TEMPLATE(BM_StaticCircleBuffer_payload_overwrite, counted_string, true);
+BENCHMARK_TEMPLATE(BM_StaticCircleBuffer_payload_overwrite, counted_vector, false);
+BENCHMARK_TEMPLATE(BM_StaticCircleBuffer_payload_overwrite, counted_vector, true);
+
+BENCHMARK(BM_DynamicCircleBuffer_erase_insert)->ArgsProduct({ { 1 << 10, 64 << 10 }, { 10, 50 } });
+BENCHMARK(BM_DynamicCircleBuffer_rebuild_erase_insert)->ArgsProduct({ { 1 << 10, 64 << 10 }, { 10, 50 } });
+BENCHMARK(BM_Deque_erase_insert)->ArgsProduct({ { 1 << 10, 64 << 10 }, { 10, 50 } });
+
+BENCHMARK_TEMPLATE(BM_CircleBuffer_front_pop_front_drain, resizable_static_int_buffer<4 << 10>)->Arg(64)->Arg(1 << 10)->Arg(4 << 10);
+BENCHMARK_TEMPLATE(BM_CircleBuffer_consume_drain, resizable_static_int_buffer<4 << 10>)->Arg(64)->Arg(1 << 10)->Arg(4 << 10);
+BENCHMARK_TEMPLATE(BM_CircleBuffer_consume_segments_drain, resizable_static_int_buffer<4 << 10>)->Arg(64)->Arg(1 << 10)->Arg(4 << 10);
+BENCHMARK_TEMPLATE(BM_CircleBuffer_front_pop_front_drain, jm::dynamic_circular_buffer<int>)->Arg(64)->Arg(1 << 10)->Arg(4 << 10);
+BENCHMARK_TEMPLATE(BM_CircleBuffer_consume_drain, jm::dynamic_circular_buffer<int>)->Arg(64)->Arg(1 << 10)->Arg(4 << 10);
+BENCHMARK_TEMPLATE(BM_CircleBuffer_consume_segments_drain, jm::dynamic_circular_buffer<int>)->Arg(64)->Arg(1 << 10)->Arg(4 << 10);
+
+#ifdef JM_CB_BENCHMARK_POSIX
+BENCHMARK_TEMPLATE(BM_StaticCircleBufferCreation_fresh_memory, k1kB);
+BENCHMARK_TEMPLATE(BM_StaticCircleBufferCreation_fresh_memory, k1MB);
+BENCHMARK_TEMPLATE(BM_StaticCircleBufferCreation_fresh_memory, 64 * k1MB);
+BENCHMARK_TEMPLATE(BM_DynamicCircleBufferCreation_fresh_memory, k1kB);
+BENCHMARK_TEMPLATE(BM_DynamicCircleBufferCreation_fresh_memory, k1MB);
+BENCHMARK_TEMPLATE(BM_DynamicCircleBufferCreation_fresh_memory, 64 * k1MB);
+#endif
+
 
 
 BENCHMARK_MAIN();
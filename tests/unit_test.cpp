@@ -2,9 +2,37 @@
 
 #include <circular_buffer.hpp>
 
+#if defined(__has_include)
+#if __has_include(<sys/uio.h>)
+#define JM_CB_TEST_POSIX
+#include <circular_buffer/fd_io.hpp>
+#include <circular_buffer/lazy_page_allocator.hpp>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+#endif
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define JM_CB_TEST_LINUX
+#include <circular_buffer/async_drain.hpp>
+#include <circular_buffer/eventfd_notifier.hpp>
+#include <poll.h>
+#endif
+#endif
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <deque>
 #include <numeric>
+#include <random>
+#include <sstream>
 #include <vector>
 #include <atomic>
+#include <string>
+#include <thread>
 
 std::uint64_t num_constructions = 0;
 std::uint64_t num_deletions = 0;
@@ -849,4 +877,1390 @@ TEST(eigen, custom_alloc)
     EXPECT_EQ(std::equal(buf1.begin(), buf1.end(), buf2.begin()), true);
     *buf2.begin() = Eigen::Vector3f::Random();
     EXPECT_EQ(!std::equal(buf1.begin(), buf1.end(), buf2.begin()), true);
-}
\ No newline at end of file
+}
+
+TEST(window_aggregator, static_sum_matches_naive)
+{
+  jm::static_window_aggregator<int, 16, std::plus<int>> agg;
+  jm::static_circular_buffer<int, 16>                   naive;
+
+  EXPECT_EQ(agg.query(), 0);
+  for (int i = 0; i < 100; ++i) {
+    agg.push(i * 7 % 13);
+    naive.push_back(i * 7 % 13);
+    EXPECT_EQ(agg.query(), std::accumulate(naive.begin(), naive.end(), 0));
+  }
+
+  for (int i = 0; i < 10; ++i) {
+    agg.pop();
+    naive.pop_front();
+    EXPECT_EQ(agg.query(), std::accumulate(naive.begin(), naive.end(), 0));
+  }
+  EXPECT_EQ(agg.size(), naive.size());
+}
+
+TEST(window_aggregator, dynamic_non_commutative)
+{
+  struct concat {
+    std::string operator()(const std::string& a, const std::string& b) const { return a + b; }
+  };
+
+  jm::dynamic_window_aggregator<std::string, concat> agg;
+  agg.reserve(5);
+
+  std::string expected;
+  for (char c = 'a'; c <= 'z'; ++c) {
+    agg.push(std::string(1, c));
+    expected += c;
+    if (expected.size() > 5)
+      expected.erase(0, 1);
+    EXPECT_EQ(agg.query(), expected);
+
+    if (c % 4 == 0) {
+      agg.pop();
+      expected.erase(0, 1);
+      EXPECT_EQ(agg.query(), expected);
+    }
+  }
+
+  while (!agg.empty())
+    agg.pop();
+  EXPECT_EQ(agg.query(), std::string());
+}
+
+TEST(range_sum_index, sub_windows_match_naive)
+{
+  jm::range_sum_index<long long>         index(13);
+  jm::dynamic_circular_buffer<long long> naive(13);
+
+  for (long long i = 0; i < 60; ++i) {
+    index.push_back(i * i % 17);
+    naive.push_back(i * i % 17);
+    if (i % 7 == 6) {
+      index.pop_front();
+      naive.pop_front();
+    }
+
+    ASSERT_EQ(index.size(), naive.size());
+    std::vector<long long> values(naive.begin(), naive.end());
+    for (std::size_t first = 0; first <= values.size(); ++first)
+      for (std::size_t last = first; last <= values.size(); ++last)
+        EXPECT_EQ(index.sum(first, last),
+                  std::accumulate(values.begin() + static_cast<std::ptrdiff_t>(first),
+                                  values.begin() + static_cast<std::ptrdiff_t>(last), 0LL));
+  }
+  EXPECT_EQ(index.sum_last(3), index.sum(index.size() - 3, index.size()));
+}
+
+TEST(range_sum_index, evicted_outlier_leaves_no_residue)
+{
+  jm::range_sum_index<double> index(8);
+  index.push_back(1e20);
+  for (int i = 0; i < 8; ++i)
+    index.push_back(0.25);
+
+  EXPECT_EQ(index.total(), 2.0);
+  EXPECT_EQ(index.sum_last(3), 0.75);
+}
+
+TEST(order_statistics_window, static_matches_sorted_copy)
+{
+  jm::static_order_statistics_window<int, 31> window;
+  std::uint32_t                                state = 12345;
+
+  for (int i = 0; i < 500; ++i) {
+    state = state * 1664525u + 1013904223u;
+    window.push(static_cast<int>(state >> 24) % 20); // plenty of duplicates
+    if (i % 11 == 10)
+      window.pop();
+
+    std::vector<int> sorted(window.buffer().begin(), window.buffer().end());
+    std::sort(sorted.begin(), sorted.end());
+    ASSERT_EQ(window.size(), sorted.size());
+    for (std::size_t k = 0; k < sorted.size(); ++k)
+      EXPECT_EQ(window.nth(k), sorted[k]);
+    EXPECT_EQ(window.median(), sorted[sorted.size() / 2]);
+    EXPECT_EQ(window.min(), sorted.front());
+    EXPECT_EQ(window.max(), sorted.back());
+  }
+}
+
+TEST(order_statistics_window, dynamic_quantiles)
+{
+  jm::dynamic_order_statistics_window<double, std::greater<double>> window;
+  window.reserve(101);
+  for (int i = 0; i < 300; ++i)
+    window.push(static_cast<double>(i));
+
+  // window holds 199..299, ordered from the largest
+  EXPECT_EQ(window.quantile(0.), 299.);
+  EXPECT_EQ(window.quantile(1.), 199.);
+  EXPECT_EQ(window.quantile(0.25), 274.);
+  EXPECT_EQ(window.median(), 249.);
+
+  window.clear();
+  EXPECT_TRUE(window.empty());
+  window.push(1.);
+  EXPECT_EQ(window.median(), 1.);
+}
+
+TEST(segments, static_array_one_two)
+{
+  auto cb = gen_filled_cb(16);
+  for (int i = 16; i < 21; ++i)
+    cb.push_back(i);
+
+  auto one = cb.array_one();
+  auto two = cb.array_two();
+  ASSERT_EQ(one.second + two.second, cb.size());
+  std::vector<int> joined(one.first, one.first + one.second);
+  joined.insert(joined.end(), two.first, two.first + two.second);
+  EXPECT_TRUE(std::equal(joined.begin(), joined.end(), cb.begin()));
+
+  cb.clear();
+  EXPECT_EQ(cb.array_one().second, 0u);
+  EXPECT_EQ(cb.array_two().second, 0u);
+}
+
+TEST(segments, dynamic_array_one_two)
+{
+  auto cb = dynamic_gen_filled_cb(16, 21);
+  cb.pop_front();
+
+  const auto& ccb = cb;
+  auto        one = ccb.array_one();
+  auto        two = ccb.array_two();
+  ASSERT_EQ(one.second + two.second, cb.size());
+  EXPECT_EQ(*one.first, 6);
+  EXPECT_EQ(two.first[two.second - 1], 20);
+  EXPECT_TRUE(std::equal(one.first, one.first + one.second, cb.begin()));
+}
+
+TEST(fir_filter, matches_direct_convolution_across_wrap)
+{
+  const std::vector<double> taps{ 0.5, -1., 2., 0.25, 3. };
+  jm::fir_filter<double>    filter(taps.begin(), taps.end());
+
+  jm::dynamic_circular_buffer<double> in(37);
+  jm::dynamic_circular_buffer<double> out(1000);
+  std::vector<double>                 samples;
+
+  for (std::size_t block : { 1u, 7u, 30u, 3u, 17u, 29u, 11u }) {
+    for (std::size_t i = 0; i < block; ++i) {
+      samples.push_back(static_cast<double>(samples.size() % 13) - 6.);
+      in.push_back(samples.back());
+    }
+    filter.process(in, block, out);
+  }
+
+  ASSERT_EQ(out.size(), samples.size());
+  auto it = out.begin();
+  for (std::size_t n = 0; n < samples.size(); ++n, ++it) {
+    double expected = 0.;
+    for (std::size_t k = 0; k < taps.size() && k <= n; ++k)
+      expected += taps[k] * samples[n - k];
+    EXPECT_EQ(*it, expected);
+  }
+}
+
+TEST(fir_filter, correlator_reverses_taps)
+{
+  const float probe[] = { 1.f, 2.f, 3.f };
+  auto        filter = jm::fir_filter<float>::correlator(std::begin(probe), std::end(probe));
+
+  EXPECT_EQ(filter.taps(), (std::vector<float>{ 3.f, 2.f, 1.f }));
+
+  jm::static_circular_buffer<float, 8> in{ 1.f, 2.f, 3.f };
+  jm::static_circular_buffer<float, 8> out;
+  filter.process(in, 3, out);
+  EXPECT_EQ(out.back(), 14.f);
+}
+
+TEST(random_access, static_and_dynamic_index)
+{
+  auto scb = gen_filled_cb(16);
+  auto dcb = dynamic_gen_filled_cb(16, 16);
+  for (int i = 16; i < 23; ++i) {
+    scb.push_back(i);
+    dcb.push_back(i);
+  }
+
+  for (std::size_t i = 0; i < scb.size(); ++i) {
+    EXPECT_EQ(scb[i], static_cast<int>(i) + 7);
+    EXPECT_EQ(dcb[i], static_cast<int>(i) + 7);
+    EXPECT_EQ(scb.at(i), dcb.at(i));
+  }
+
+  scb.pop_front();
+  dcb.pop_back();
+  EXPECT_EQ(scb[0], 8);
+  EXPECT_EQ(dcb[dcb.size() - 1], 21);
+  EXPECT_THROW(scb.at(15), std::out_of_range);
+  EXPECT_THROW(dcb.at(15), std::out_of_range);
+}
+
+TEST(delay_line, interpolators_are_exact_on_polynomials)
+{
+  jm::static_delay_line<double, 64, jm::linear_interpolation>   linear;
+  jm::static_delay_line<double, 64, jm::cubic_interpolation>    cubic;
+  jm::static_delay_line<double, 64, jm::lagrange_interpolation> lagrange;
+
+  // sample n ( n = 0 is the newest ) of the pushed signal is 3 * n + 1 for the linear
+  // line and n^3 - n for the lagrange one
+  for (int i = 99; i >= 0; --i) {
+    linear.push(3. * i + 1.);
+    cubic.push(3. * i + 1.);
+    lagrange.push(static_cast<double>(i) * i * i - i);
+  }
+
+  for (double d = 1.; d < 60.; d += 0.375) {
+    EXPECT_DOUBLE_EQ(linear.read(d), 3. * d + 1.);
+    EXPECT_DOUBLE_EQ(cubic.read(d), 3. * d + 1.);
+    EXPECT_NEAR(lagrange.read(d), d * d * d - d, 1e-9);
+  }
+
+  // outside of the stored history the nearest sample is used
+  EXPECT_EQ(linear.read(-2.), 1.);
+  EXPECT_EQ(linear.read(500.), 3. * 63 + 1.);
+}
+
+TEST(delay_line, batched_read_matches_single_reads)
+{
+  jm::dynamic_delay_line<float, jm::cubic_interpolation> line;
+  line.reserve(256);
+  for (int i = 0; i < 1000; ++i)
+    line.push(static_cast<float>(i % 37) * 0.5f);
+
+  std::vector<float> delays, out(150);
+  for (int i = 0; i < 150; ++i)
+    delays.push_back(static_cast<float>(i) * 1.7f);
+
+  line.read(delays.data(), out.data(), delays.size());
+  for (std::size_t i = 0; i < delays.size(); ++i)
+    EXPECT_EQ(out[i], line.read(delays[i]));
+}
+
+TEST(time_window_buffer, evicts_by_age_and_grows_on_spikes)
+{
+  jm::time_window_buffer<int, long long> events(100, 4);
+
+  for (long long t = 0; t < 1000; t += 10)
+    events.push(t, static_cast<int>(t));
+
+  // steady rate of 10 events per window fits without growing past 16
+  EXPECT_EQ(events.size(), 10u);
+  EXPECT_EQ(events.front().time, 900);
+  EXPECT_LE(events.capacity(), 16u);
+
+  // spike of 100 events at the same time
+  for (int i = 0; i < 100; ++i)
+    events.push(1000, i);
+  EXPECT_EQ(events.size(), 109u);
+  EXPECT_GE(events.capacity(), 109u);
+
+  events.evict_expired(1095);
+  EXPECT_EQ(events.size(), 100u);
+  events.evict_expired(1100);
+  EXPECT_TRUE(events.empty());
+}
+
+TEST(time_window_buffer, range_lookup_across_wrap)
+{
+  jm::time_window_buffer<int, long long> events(50, 8);
+
+  for (long long t = 0; t < 83; t += 2)
+    events.push(t, static_cast<int>(t) * 10);
+  ASSERT_GT(events.buffer().array_two().second, 0u);
+
+  for (long long t0 = 20; t0 < 90; t0 += 3)
+    for (long long t1 = t0; t1 < 95; t1 += 7) {
+      const auto view = events.range(t0, t1);
+
+      std::vector<long long> times;
+      for (std::size_t i = 0; i < view.one.second; ++i)
+        times.push_back(view.one.first[i].time);
+      for (std::size_t i = 0; i < view.two.second; ++i)
+        times.push_back(view.two.first[i].time);
+
+      std::vector<long long> expected;
+      for (const auto& e : events.buffer())
+        if (e.time >= t0 && e.time < t1)
+          expected.push_back(e.time);
+      EXPECT_EQ(times, expected);
+      EXPECT_EQ(view.size(), expected.size());
+    }
+}
+
+TEST(cascading_buffer, levels_consolidate_completed_blocks)
+{
+  jm::cascading_buffer<int, 8, 4, 3> history;
+  static_assert(decltype(history)::resolution(2) == 16, "level 2 entries cover 16 samples");
+
+  for (int i = 1; i <= 1000; ++i)
+    history.push(i % 2 ? i : -i);
+
+  EXPECT_EQ(history.raw().size(), 8u);
+  EXPECT_EQ(history.raw().back(), -1000);
+
+  const auto& minutes = history.level(1);
+  EXPECT_EQ(minutes.size(), 8u);
+  EXPECT_EQ(minutes.back().min, -1000);
+  EXPECT_EQ(minutes.back().max, 999);
+  EXPECT_EQ(minutes.back().sum, 997 - 998 + 999 - 1000);
+  EXPECT_EQ(minutes.back().last, -1000);
+  EXPECT_EQ(minutes.back().count, 4u);
+
+  // 1000 samples complete 62 blocks of 16, the newest one being 977..992
+  const auto& hours = history.level(2);
+  EXPECT_EQ(hours.size(), 8u);
+  EXPECT_EQ(hours.back().min, -992);
+  EXPECT_EQ(hours.back().max, 991);
+  EXPECT_EQ(hours.back().last, -992);
+  EXPECT_EQ(hours.back().count, 16u);
+  EXPECT_EQ(hours.back().mean(), -8 / 16);
+
+  const auto last_two = history.summarize(2, 2);
+  EXPECT_EQ(last_two.count, 32u);
+  EXPECT_EQ(last_two.min, -992);
+  EXPECT_EQ(last_two.max, 991);
+  EXPECT_EQ(history.summarize(0, 3).sum, -998 + 999 - 1000);
+}
+
+TEST(compressed_series, round_trips_points_across_blocks)
+{
+  jm::compressed_series<double, 256> series(64);
+  std::vector<std::pair<std::int64_t, double>> points;
+
+  std::int64_t t = 1000;
+  double       v = 20.5;
+  for (int i = 0; i < 2000; ++i) {
+    t += i % 7 == 0 ? 1000 + (i % 5) * 300 : 1000; // jittered sampling interval
+    v += i % 11 == 0 ? 0.25 : 0.;
+    if (i % 97 == 0)
+      t += std::int64_t(1) << 40; // gap that needs a raw timestamp
+    if (i % 89 == 0)
+      v = -v * 1e10;
+    points.emplace_back(t, v);
+    series.push(t, v);
+  }
+
+  EXPECT_EQ(series.size(), points.size());
+  EXPECT_GT(series.block_count(), 1u);
+  EXPECT_LT(series.compressed_bytes(), points.size() * 16 / 3);
+
+  std::size_t i = 0;
+  for (const auto& p : series) {
+    ASSERT_EQ(p.time, points[i].first);
+    ASSERT_EQ(p.value, points[i].second);
+    ++i;
+  }
+  EXPECT_EQ(i, points.size());
+
+  // block granular access
+  const auto b = series.find_block(points[1500].first);
+  EXPECT_LE(series.block_at(b).first_time(), points[1500].first);
+  EXPECT_GE(series.block_at(b).last_time(), points[1500].first);
+  auto it = series.block_begin(b);
+  while (it->time != points[1500].first)
+    ++it;
+  EXPECT_EQ(it->value, points[1500].second);
+}
+
+TEST(compressed_series, evicts_whole_blocks)
+{
+  jm::compressed_series<std::int64_t, 64> series(4);
+  for (std::int64_t i = 0; i < 10000; ++i)
+    series.push(i * 10, i * i);
+
+  EXPECT_EQ(series.block_count(), 4u);
+
+  std::size_t in_blocks = 0;
+  for (std::size_t b = 0; b < series.block_count(); ++b)
+    in_blocks += series.block_at(b).size();
+  EXPECT_EQ(series.size(), in_blocks);
+
+  std::int64_t expected = series.block_at(0).first_time() / 10;
+  for (const auto& p : series) {
+    EXPECT_EQ(p.time, expected * 10);
+    EXPECT_EQ(p.value, expected * expected);
+    ++expected;
+  }
+  EXPECT_EQ(expected, 10000);
+}
+
+TEST(byte_record_ring, records_stay_contiguous_across_wrap)
+{
+  jm::byte_record_ring ring(256);
+  EXPECT_EQ(ring.capacity(), 256u);
+  EXPECT_TRUE(ring.read_next().empty());
+  EXPECT_EQ(ring.try_write(ring.max_record_size() + 1), nullptr);
+
+  // an empty ring accepts max_record_size() whatever offset the last record left
+  for (std::size_t offset = 8; offset < ring.capacity(); offset += 8) {
+    jm::byte_record_ring shifted(256);
+    for (std::size_t i = 0; i < offset; i += 8) { // header only records
+      ASSERT_TRUE(shifted.write("", 0));
+      shifted.read_next();
+      shifted.release();
+    }
+    const std::string largest(shifted.max_record_size(), 'l');
+    ASSERT_TRUE(shifted.write(largest.data(), largest.size())) << "offset " << offset;
+    EXPECT_EQ(shifted.read_next().size, largest.size());
+  }
+
+  std::size_t written = 0, read = 0;
+  for (int round = 0; round < 200; ++round) {
+    // odd sizes so the ends of the records keep landing in different places
+    const std::string message(static_cast<std::size_t>(1 + (round * 37) % 90), static_cast<char>('a' + round % 26));
+    while (!ring.write(message.data(), message.size())) {
+      const auto record = ring.read_next();
+      ASSERT_FALSE(record.empty());
+      const std::size_t expected_size = static_cast<std::size_t>(1 + (read * 37) % 90);
+      ASSERT_EQ(record.size, expected_size);
+      EXPECT_EQ(std::string(record.data, record.size), std::string(expected_size, static_cast<char>('a' + read % 26)));
+      ring.release();
+      ++read;
+    }
+    ++written;
+  }
+
+  while (!ring.read_next().empty()) {
+    ring.release();
+    ++read;
+  }
+  EXPECT_EQ(read, written);
+  EXPECT_TRUE(ring.empty());
+}
+
+TEST(byte_record_ring, spsc_threads)
+{
+  jm::spsc_byte_record_ring ring(4096);
+  constexpr std::uint32_t count = 100000;
+
+  std::thread producer([&] {
+    for (std::uint32_t i = 0; i < count; ++i) {
+      const std::size_t size = sizeof(i) + i % 300;
+      char*             dest;
+      while ((dest = ring.try_write(size)) == nullptr)
+        std::this_thread::yield();
+      std::memcpy(dest, &i, sizeof(i));
+      std::memset(dest + sizeof(i), static_cast<int>(i & 0xff), size - sizeof(i));
+      ring.commit();
+    }
+  });
+
+  bool ok = true;
+  for (std::uint32_t i = 0; i < count && ok; ++i) {
+    jm::spsc_byte_record_ring::record record;
+    while ((record = ring.read_next()).empty())
+      std::this_thread::yield();
+
+    std::uint32_t value;
+    std::memcpy(&value, record.data, sizeof(value));
+    ok = value == i && record.size == sizeof(i) + i % 300 &&
+         (record.size == sizeof(i) || static_cast<unsigned char>(record.data[record.size - 1]) == (i & 0xff));
+    ring.release();
+  }
+  producer.join();
+
+  EXPECT_TRUE(ok);
+  EXPECT_TRUE(ring.empty());
+}
+
+TEST(command_ring, dispatches_heterogeneous_commands_in_order)
+{
+  struct alignas(32) wide_command {
+    double values[5];
+    void   operator()(std::vector<double>& log) const { log.push_back(values[0] + values[4]); }
+  };
+
+  std::vector<double> log;
+  {
+    jm::command_ring<void(std::vector<double>&)> ring(1024);
+    std::size_t                                  pushed = 0;
+
+    num_constructions = num_deletions = 0;
+    for (int i = 0; i < 40; ++i) {
+      bool ok;
+      if (i % 3 == 0)
+        ok = ring.try_push([i](std::vector<double>& l) { l.push_back(i); });
+      else if (i % 3 == 1)
+        ok = ring.try_emplace<wide_command>(wide_command{ { double(i), 0, 0, 0, 0.5 } });
+      else {
+        leak_checker checker;
+        ok = ring.try_push([i, checker](std::vector<double>& l) { l.push_back(static_cast<float>(i) + checker.aa[0] - 1.f); });
+      }
+
+      if (!ok) {
+        pushed -= ring.dispatch_all(log);
+        --i;
+        continue;
+      }
+      ++pushed;
+    }
+
+    EXPECT_TRUE(ring.dispatch(log));
+    --pushed;
+    EXPECT_GT(pushed, 0u); // the rest is destroyed without running
+  }
+  EXPECT_EQ(num_constructions, num_deletions);
+
+  ASSERT_GT(log.size(), 20u);
+  for (std::size_t i = 0; i < log.size(); ++i)
+    EXPECT_EQ(log[i], static_cast<double>(i) + (i % 3 == 1 ? 0.5 : 0.));
+
+  // move only and rvalue reference arguments, shared by every command of dispatch_all
+  jm::command_ring<void(std::unique_ptr<int>, std::string&&)> moving(256);
+  int                                                         seen = 0;
+  const auto add = [&seen](const std::unique_ptr<int>& p, std::string&& s) { seen += *p + static_cast<int>(s.size()); };
+  for (int i = 0; i < 3; ++i)
+    ASSERT_TRUE(moving.try_push(add));
+
+  std::unique_ptr<int> value(new int(10));
+  std::string          text("ab");
+  EXPECT_EQ(moving.dispatch_all(value, text), 3u);
+  EXPECT_EQ(seen, 36);
+
+  ASSERT_TRUE(moving.try_push(add));
+  EXPECT_TRUE(moving.dispatch(std::unique_ptr<int>(new int(1)), std::string("xyz")));
+  EXPECT_EQ(seen, 40);
+}
+
+TEST(CircularBuffer, free_segments_and_bulk_commit)
+{
+  jm::static_circular_buffer<int, 8> cb;
+  for (int i = 0; i < 6; ++i)
+    cb.push_back(i);
+  cb.erase_begin(4);
+  EXPECT_EQ(cb.size(), 2u);
+  EXPECT_EQ(cb.front(), 4);
+
+  auto one = cb.free_array_one();
+  auto two = cb.free_array_two();
+  EXPECT_EQ(one.second + two.second, 6u);
+  EXPECT_EQ(one.second, 1u); // slot 7, the first push went to slot 1
+  std::iota(one.first, one.first + one.second, 6);
+  std::iota(two.first, two.first + two.second, 7);
+  cb.commit_back(5);
+
+  std::vector<int> expected(7);
+  std::iota(expected.begin(), expected.end(), 4);
+  EXPECT_TRUE(std::equal(cb.begin(), cb.end(), expected.begin()));
+  EXPECT_EQ(cb.back(), 10);
+
+  jm::dynamic_circular_buffer<char> dcb(4);
+  dcb.commit_back(0);
+  EXPECT_TRUE(dcb.empty());
+  EXPECT_EQ(dcb.free_array_one().second + dcb.free_array_two().second, 4u);
+}
+
+#ifdef JM_CB_TEST_POSIX
+TEST(fd_io, pipe_round_trip_with_partial_transfers)
+{
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  ASSERT_EQ(fcntl(fds[0], F_SETFL, O_NONBLOCK), 0);
+
+  jm::dynamic_circular_buffer<char> in(7), out(5);
+  EXPECT_EQ(jm::read_from(fds[0], in), -1);
+  EXPECT_EQ(errno, EAGAIN);
+
+  std::string sent, received;
+  for (int i = 0; i < 200; ++i) {
+    out.push_back(static_cast<char>('a' + i % 26));
+    sent.push_back(static_cast<char>('a' + i % 26));
+    if (out.full()) {
+      ASSERT_EQ(jm::write_to(fds[1], out), 5);
+    }
+
+    if (i % 3 == 0) {
+      const auto n = jm::read_from(fds[0], in);
+      ASSERT_TRUE(n > 0 || (n < 0 && errno == EAGAIN));
+    }
+    if (in.full()) {
+      EXPECT_EQ(jm::read_from(fds[0], in), -1);
+      EXPECT_EQ(errno, ENOBUFS);
+    }
+    while (in.size() > 3) {
+      received.push_back(in.front());
+      in.pop_front();
+    }
+  }
+
+  close(fds[1]);
+  while (jm::read_from(fds[0], in) > 0 || !in.empty()) {
+    received.append(in.begin(), in.end());
+    in.clear();
+  }
+  close(fds[0]);
+  EXPECT_EQ(received, sent);
+}
+
+TEST(fd_io, socketpair_static_buffer)
+{
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+  jm::static_circular_buffer<char, 16> out, in;
+  for (char c : std::string("0123456789ab"))
+    out.push_back(c);
+  out.erase_begin(10); // "ab" left at the end of the storage
+  for (char c : std::string("cdefghij"))
+    out.push_back(c);
+
+  EXPECT_EQ(jm::write_to(fds[0], out), 10);
+  EXPECT_TRUE(out.empty());
+  EXPECT_EQ(jm::write_to(fds[0], out), 0);
+
+  EXPECT_EQ(jm::read_from(fds[1], in), 10);
+  EXPECT_EQ(std::string(in.begin(), in.end()), "abcdefghij");
+  close(fds[0]);
+  close(fds[1]);
+}
+#endif
+
+#ifdef JM_CB_TEST_LINUX
+TEST(async_drain, writes_the_ring_in_order_with_every_backend)
+{
+  using drain_type = jm::async_drain<jm::dynamic_circular_buffer<std::uint32_t>>;
+  for (auto kind : { drain_type::backend::automatic, drain_type::backend::thread }) {
+    std::FILE* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    const int fd = fileno(file);
+
+    jm::dynamic_circular_buffer<std::uint32_t> ring(1000);
+    {
+      drain_type drain(ring, fd, 0, 3, 128, kind);
+      for (std::uint32_t i = 0; i < 100000; ++i) {
+        while (ring.full())
+          EXPECT_GT(drain.wait(), 0u);
+        ring.push_back(i);
+        drain.poll();
+        EXPECT_LE(drain.in_flight(), 3u);
+      }
+      drain.flush();
+      EXPECT_TRUE(ring.empty());
+      EXPECT_EQ(drain.bytes_written(), 100000u * sizeof(std::uint32_t));
+    }
+
+    std::vector<std::uint32_t> content(100000);
+    ASSERT_EQ(pread(fd, content.data(), content.size() * sizeof(std::uint32_t), 0),
+              static_cast<ssize_t>(content.size() * sizeof(std::uint32_t)));
+    std::vector<std::uint32_t> expected(content.size());
+    std::iota(expected.begin(), expected.end(), 0u);
+    EXPECT_EQ(content, expected);
+    std::fclose(file);
+  }
+}
+#endif
+
+TEST(snapshot, stream_round_trip_keeps_order_across_wrap)
+{
+  jm::static_circular_buffer<double, 16> cb;
+  for (int i = 0; i < 27; ++i)
+    cb.push_back(i * 0.5);
+
+  std::stringstream stream;
+  jm::save(stream, cb);
+
+  jm::static_circular_buffer<double, 16> restored;
+  restored.push_back(-1.);
+  jm::load(stream, restored);
+  EXPECT_TRUE(std::equal(cb.begin(), cb.end(), restored.begin(), restored.end()));
+
+  // a dynamic buffer takes the capacity of the snapshot
+  stream.seekg(0);
+  jm::dynamic_circular_buffer<double> dynamic(3);
+  jm::load(stream, dynamic);
+  EXPECT_EQ(dynamic.max_size(), 16u);
+  EXPECT_TRUE(std::equal(cb.begin(), cb.end(), dynamic.begin(), dynamic.end()));
+
+  stream.seekg(0);
+  jm::static_circular_buffer<float, 16> wrong_type;
+  EXPECT_THROW(jm::load(stream, wrong_type), std::runtime_error);
+  stream.seekg(0);
+  jm::static_circular_buffer<double, 8> wrong_capacity;
+  EXPECT_THROW(jm::load(stream, wrong_capacity), std::runtime_error);
+
+  // the capacity a dynamic buffer takes is bounded before anything is allocated
+  stream.seekg(0);
+  EXPECT_THROW(jm::load(stream, dynamic, 15), std::runtime_error);
+  stream.seekg(0);
+  jm::load(stream, dynamic, 16);
+  EXPECT_EQ(dynamic.size(), cb.size());
+
+  std::string         forged = stream.str();
+  const std::uint64_t huge = std::uint64_t(1) << 62;
+  std::memcpy(&forged[offsetof(jm::snapshot_header, capacity)], &huge, sizeof(huge));
+  std::stringstream forged_stream(forged);
+  EXPECT_THROW(jm::load(forged_stream, dynamic), std::runtime_error);
+}
+
+#ifdef JM_CB_TEST_POSIX
+TEST(snapshot, fd_round_trip)
+{
+  std::FILE* file = std::tmpfile();
+  ASSERT_NE(file, nullptr);
+  const int fd = fileno(file);
+
+  jm::dynamic_circular_buffer<std::uint64_t> cb(1000), empty(10);
+  for (std::uint64_t i = 0; i < 1700; ++i)
+    cb.push_back(i * i);
+  jm::save(fd, cb);
+  jm::save(fd, empty);
+
+  ASSERT_EQ(lseek(fd, 0, SEEK_SET), 0);
+  jm::dynamic_circular_buffer<std::uint64_t> restored, restored_empty(4);
+  restored_empty.push_back(1);
+  jm::load(fd, restored);
+  jm::load(fd, restored_empty);
+  EXPECT_TRUE(std::equal(cb.begin(), cb.end(), restored.begin(), restored.end()));
+  EXPECT_TRUE(restored_empty.empty());
+  EXPECT_EQ(restored_empty.max_size(), 10u);
+  EXPECT_THROW(jm::load(fd, restored), std::runtime_error);
+  std::fclose(file);
+}
+#endif
+
+TEST(spilling_circular_buffer, bursts_are_replayed_in_order_without_loss)
+{
+  jm::spilling_circular_buffer<std::uint32_t> buffer(64, 100, 16);
+  std::uint32_t pushed = 0, popped = 0;
+
+  const auto drain = [&](std::size_t count) {
+    for (; count != 0 && !buffer.empty(); --count, ++popped) {
+      ASSERT_EQ(buffer.front(), popped);
+      buffer.pop_front();
+    }
+  };
+
+  for (; pushed < 640; ++pushed) // a burst of 10x the ring
+    buffer.push_back(pushed);
+  EXPECT_EQ(buffer.size(), 640u);
+  EXPECT_LE(buffer.memory().size(), 64u);
+  EXPECT_EQ(buffer.spilled() + buffer.memory().size(), 640u);
+
+  drain(300);
+  for (int round = 0; round < 50; ++round) { // keeps spilling while replaying
+    for (int i = 0; i < 37; ++i)
+      buffer.push_back(pushed++);
+    drain(29);
+  }
+  drain(buffer.size());
+
+  EXPECT_EQ(popped, pushed);
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(buffer.spilled(), 0u);
+
+  buffer.push_back(1);
+  buffer.clear();
+  EXPECT_TRUE(buffer.empty());
+}
+
+#ifdef JM_CB_TEST_LINUX
+std::size_t resident_bytes()
+{
+  std::FILE*    statm = std::fopen("/proc/self/statm", "r");
+  unsigned long size = 0, resident = 0;
+  if (statm == nullptr || std::fscanf(statm, "%lu %lu", &size, &resident) != 2)
+    resident = 0;
+  if (statm != nullptr)
+    std::fclose(statm);
+  return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+#endif
+
+#ifdef JM_CB_TEST_POSIX
+TEST(lazy_page_allocator, pages_are_committed_on_touch_and_reclaimed)
+{
+  constexpr std::size_t capacity = std::size_t(1) << 27; // 1 GB of std::uint64_t
+#ifdef JM_CB_TEST_LINUX
+  const std::size_t before = resident_bytes();
+#endif
+  jm::lazy_circular_buffer<std::uint64_t> cb(capacity);
+  EXPECT_EQ(cb.max_size(), capacity);
+
+  // a 2 MB window sliding over the first 32 MB of the ring
+  for (std::uint64_t i = 0; i < (32 << 20) / 8; ++i) {
+    cb.push_back(i);
+    if (cb.size() > (2 << 20) / 8)
+      cb.pop_front();
+  }
+#ifdef JM_CB_TEST_LINUX
+  EXPECT_LT(resident_bytes() - before, std::size_t(64) << 20);
+#endif
+
+  EXPECT_GE(jm::reclaim_unused_pages(cb), (29u << 20));
+#ifdef JM_CB_TEST_LINUX
+  EXPECT_LT(resident_bytes() - before, std::size_t(16) << 20);
+#endif
+
+  std::uint64_t expected = (30 << 20) / 8;
+  for (auto value : cb)
+    EXPECT_EQ(value, expected++);
+}
+#endif
+
+#ifdef JM_CB_HAS_COROUTINES
+using st_channel = jm::channel<int, jm::inline_scheduler>;
+
+jm::detached_task produce(st_channel& ch, int count)
+{
+  for (int i = 0; i < count; ++i)
+    EXPECT_TRUE(co_await ch.push(i));
+  ch.close();
+}
+
+jm::detached_task consume(st_channel& ch, std::vector<int>& out)
+{
+  while (auto value = co_await ch.pop())
+    out.push_back(*value);
+}
+
+TEST(coroutine_channel, single_threaded_handoff_in_order)
+{
+  for (std::size_t capacity : std::initializer_list<std::size_t>{ 0, 1, 4 }) {
+    jm::inline_scheduler scheduler;
+    st_channel           ch(scheduler, capacity);
+    std::vector<int>     received;
+
+    jm::spawn(scheduler, consume(ch, received));
+    jm::spawn(scheduler, produce(ch, 1000));
+    scheduler.run();
+
+    std::vector<int> expected(1000);
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(received, expected);
+  }
+}
+
+using mt_channel = jm::channel<int, jm::thread_pool_executor, std::mutex>;
+
+jm::detached_task produce_shared(mt_channel& ch, int first, int count, std::atomic<int>& producers)
+{
+  for (int i = first; i < first + count; ++i)
+    co_await ch.push(i);
+  if (--producers == 0)
+    ch.close();
+}
+
+jm::detached_task consume_shared(mt_channel& ch, std::atomic<long long>& sum, std::atomic<int>& consumers)
+{
+  while (auto value = co_await ch.pop())
+    sum += *value;
+  --consumers;
+}
+
+TEST(coroutine_channel, thread_pool_producers_and_consumers)
+{
+  std::atomic<long long> sum{ 0 };
+  std::atomic<int>       producers{ 3 }, consumers{ 2 };
+  {
+    jm::thread_pool_executor executor(3);
+    mt_channel               ch(executor, 8);
+
+    jm::spawn(executor, consume_shared(ch, sum, consumers));
+    jm::spawn(executor, consume_shared(ch, sum, consumers));
+    for (int p = 0; p < 3; ++p)
+      jm::spawn(executor, produce_shared(ch, p * 10000, 10000, producers));
+
+    while (consumers != 0)
+      std::this_thread::yield();
+  }
+  EXPECT_EQ(sum, 30000ll * 29999 / 2);
+}
+#endif
+
+#ifdef JM_CB_TEST_LINUX
+bool fd_readable(int fd, int timeout_ms)
+{
+  pollfd p = { fd, POLLIN, 0 };
+  return poll(&p, 1, timeout_ms) == 1;
+}
+
+TEST(eventfd_notifier, readable_at_high_watermark_and_coalesced)
+{
+  jm::notifying_byte_record_ring ring(1024, 4u, std::chrono::hours(1));
+  const int                      fd = ring.notifier().readable_fd();
+
+  for (int i = 0; i < 3; ++i)
+    ASSERT_TRUE(ring.write(&i, sizeof(i)));
+  EXPECT_FALSE(fd_readable(fd, 0));
+  for (int i = 3; i < 10; ++i)
+    ASSERT_TRUE(ring.write(&i, sizeof(i)));
+  EXPECT_TRUE(fd_readable(fd, 0));
+  // one timer arming and one eventfd write for the whole batch
+  EXPECT_EQ(ring.notifier().syscalls(), 2u);
+
+  ring.notifier().ack_readable();
+  EXPECT_FALSE(fd_readable(fd, 0));
+  int count = 0;
+  for (auto r = ring.read_next(); !r.empty(); r = ring.read_next(), ++count)
+    ring.release();
+  EXPECT_EQ(count, 10);
+}
+
+TEST(eventfd_notifier, readable_after_delay_and_writable_at_low_watermark)
+{
+  jm::notifying_byte_record_ring ring(256, 1000u, std::chrono::milliseconds(1), 2u);
+  auto&                          notifier = ring.notifier();
+
+  const std::uint64_t value = 42;
+  ASSERT_TRUE(ring.write(&value, sizeof(value)));
+  EXPECT_TRUE(fd_readable(notifier.readable_fd(), 1000));
+  notifier.ack_readable();
+
+  while (ring.write(&value, sizeof(value))) {}
+  EXPECT_FALSE(fd_readable(notifier.writable_fd(), 0));
+
+  std::thread consumer([&] {
+    for (auto r = ring.read_next(); !r.empty(); r = ring.read_next())
+      ring.release();
+  });
+  EXPECT_TRUE(fd_readable(notifier.writable_fd(), 1000));
+  consumer.join();
+  notifier.ack_writable();
+  EXPECT_FALSE(fd_readable(notifier.writable_fd(), 0));
+  EXPECT_TRUE(ring.write(&value, sizeof(value)));
+}
+#endif
+
+TEST(overflow, reject_and_throw_leave_the_buffer_unchanged)
+{
+  jm::static_circular_buffer<int, 4, jm::overflow::reject> rejecting;
+  for (int i = 0; i < 4; ++i)
+    EXPECT_TRUE(rejecting.push_back(i));
+  EXPECT_FALSE(rejecting.push_back(4));
+  EXPECT_FALSE(rejecting.push_front(-1));
+  EXPECT_FALSE(rejecting.emplace_back(4));
+  EXPECT_EQ(std::vector<int>(rejecting.begin(), rejecting.end()), (std::vector<int>{ 0, 1, 2, 3 }));
+  rejecting.pop_front();
+  EXPECT_TRUE(rejecting.push_back(4));
+  EXPECT_EQ(rejecting.front(), 1);
+
+  jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::throw_exception> throwing(3);
+  for (int i = 0; i < 3; ++i)
+    throwing.push_front(i);
+  EXPECT_THROW(throwing.push_back(3), std::length_error);
+  EXPECT_THROW(throwing.emplace_front(3), std::length_error);
+  EXPECT_EQ(std::vector<int>(throwing.begin(), throwing.end()), (std::vector<int>{ 2, 1, 0 }));
+}
+
+TEST(overflow, grow_keeps_order_across_wrap)
+{
+  jm::dynamic_circular_buffer<std::string, std::allocator<std::string>, jm::overflow::grow> buffer(4);
+  for (int i = 0; i < 4; ++i)
+    buffer.push_back(std::to_string(i));
+  buffer.pop_front();
+  buffer.pop_front();
+  buffer.push_back("4");
+  buffer.push_back("5"); // full and wrapped
+
+  buffer.push_back(buffer.front()); // refers to an element of the old storage
+  EXPECT_EQ(buffer.max_size(), 8u);
+  buffer.push_front("1");
+  buffer.emplace_front(std::size_t(1), '0');
+  buffer.push_back("6");
+  EXPECT_EQ(buffer.max_size(), 8u);
+  buffer.push_back("7");
+  EXPECT_EQ(buffer.max_size(), 16u);
+
+  const std::vector<std::string> expected{ "0", "1", "2", "3", "4", "5", "2", "6", "7" };
+  EXPECT_EQ(std::vector<std::string>(buffer.begin(), buffer.end()), expected);
+
+  jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::grow> empty;
+  empty.push_front(1);
+  empty.push_back(2);
+  empty.push_front(0);
+  EXPECT_EQ(std::vector<int>(empty.begin(), empty.end()), (std::vector<int>{ 0, 1, 2 }));
+}
+
+TEST(buffer_stats, counts_pushes_drops_and_time_full)
+{
+  static_assert(sizeof(jm::dynamic_circular_buffer<int>) == 3 * sizeof(std::size_t) + sizeof(std::vector<int>),
+                "null_buffer_stats takes no space");
+
+  jm::static_circular_buffer<int, 4, jm::overflow::reject, jm::buffer_stats> buffer;
+  for (int i = 0; i < 6; ++i)
+    buffer.push_back(i);
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  buffer.pop_front();
+  buffer.pop_front();
+  buffer.push_back(6);
+
+  const auto values = buffer.stats().snapshot();
+  EXPECT_EQ(values.pushes, 5u);
+  EXPECT_EQ(values.pops, 2u);
+  EXPECT_EQ(values.drops, 2u);
+  EXPECT_EQ(values.overwrites, 0u);
+  EXPECT_EQ(values.high_water_mark, 4u);
+  EXPECT_GE(values.full_ns, 2000000u);
+}
+
+TEST(buffer_stats, growing_stops_the_full_time)
+{
+  jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::grow, jm::buffer_stats> buffer(4);
+  for (int i = 0; i < 4; ++i)
+    buffer.push_back(i);
+  buffer.push_back(4); // full, grows to 8
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_LT(buffer.stats().snapshot().full_ns, 10000000u);
+
+  jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::reject, jm::buffer_stats> reserved(2);
+  reserved.push_back(0);
+  reserved.push_back(1);
+  reserved.reserve(4);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const auto values = reserved.stats().snapshot();
+  EXPECT_LT(values.full_ns, 10000000u);
+  EXPECT_EQ(values.pops, 2u);
+}
+
+TEST(buffer_stats, registry_collects_every_buffer)
+{
+  typedef jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::overwrite, jm::buffer_stats> buffer_type;
+  buffer_type a(2), b(8);
+  for (int i = 0; i < 5; ++i)
+    a.push_back(i);
+  b.push_front(1);
+
+  jm::stats_registry registry;
+  registry.add("a", a);
+  registry.add("b", b);
+  auto entries = registry.collect();
+  ASSERT_EQ(entries.size(), 2u);
+  EXPECT_EQ(entries[0].name, "a");
+  EXPECT_EQ(entries[0].values.overwrites, 3u);
+  EXPECT_EQ(entries[1].values.pushes, 1u);
+
+  std::ostringstream text;
+  registry.write_text(text);
+  EXPECT_NE(text.str().find("a overwrites 3\n"), std::string::npos);
+
+  registry.remove(a);
+  entries = registry.collect();
+  ASSERT_EQ(entries.size(), 1u);
+  EXPECT_EQ(entries[0].name, "b");
+}
+
+TEST(recycle, evicted_elements_keep_their_allocations)
+{
+  jm::static_circular_buffer<std::string, 3> buffer;
+  for (int i = 0; i < 3; ++i)
+    buffer.recycle_back().assign(100, static_cast<char>('a' + i));
+
+  const char* storage = buffer.front().data();
+  std::string& slot = buffer.recycle_back(); // evicts "aaa..."
+  EXPECT_EQ(slot.data(), storage);
+  slot.assign(50, 'd');
+  EXPECT_EQ(std::vector<std::string>(buffer.begin(), buffer.end()),
+            (std::vector<std::string>{ std::string(100, 'b'), std::string(100, 'c'), std::string(50, 'd') }));
+
+  buffer.recycle_front() = "z"; // evicts the newest
+  EXPECT_EQ(buffer.front(), "z");
+  EXPECT_EQ(buffer.back(), std::string(100, 'c'));
+
+  jm::dynamic_circular_buffer<std::vector<float>> ring(2);
+  ring.recycle_back().assign(64, 1.f);
+  const float* data = ring.front().data();
+  ring.pop_front();
+  std::vector<float>& reused = ring.recycle_back();
+  reused.assign(32, 2.f);
+  ring.recycle_back().assign(16, 3.f); // the slot of the popped element, reused
+  EXPECT_EQ(ring.back().data(), data);
+  EXPECT_EQ(ring.front(), std::vector<float>(32, 2.f));
+}
+
+TEST(generate_back, fills_both_segments_and_overwrites_the_oldest)
+{
+  jm::static_circular_buffer<int, 8> buffer;
+  for (int i = 0; i < 6; ++i)
+    buffer.push_back(-1);
+  for (int i = 0; i < 4; ++i)
+    buffer.pop_front();
+
+  const auto square = [](std::size_t i) { return static_cast<int>(i * i); };
+  EXPECT_EQ(buffer.generate_back(5, square), 5u); // wraps around
+  EXPECT_EQ(std::vector<int>(buffer.begin(), buffer.end()), (std::vector<int>{ -1, -1, 0, 1, 4, 9, 16 }));
+  EXPECT_EQ(buffer.generate_back(3, square), 3u); // overwrites the two -1
+  EXPECT_EQ(std::vector<int>(buffer.begin(), buffer.end()), (std::vector<int>{ 0, 1, 4, 9, 16, 0, 1, 4 }));
+  EXPECT_EQ(buffer.generate_back(10, square), 8u);
+  EXPECT_EQ(buffer.front(), 4);
+  EXPECT_EQ(buffer.back(), 81);
+
+  jm::static_circular_buffer<std::string, 3> strings;
+  strings.generate_back(5, [](std::size_t i) { return std::to_string(i); });
+  EXPECT_EQ(std::vector<std::string>(strings.begin(), strings.end()), (std::vector<std::string>{ "2", "3", "4" }));
+}
+
+TEST(generate_back, follows_the_overflow_policy)
+{
+  const auto identity = [](std::size_t i) { return static_cast<int>(i); };
+
+  jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::reject> rejecting(4);
+  rejecting.push_back(-1);
+  EXPECT_EQ(rejecting.generate_back(5, identity), 3u);
+  EXPECT_EQ(std::vector<int>(rejecting.begin(), rejecting.end()), (std::vector<int>{ -1, 0, 1, 2 }));
+
+  jm::static_circular_buffer<int, 4, jm::overflow::throw_exception> throwing;
+  EXPECT_THROW(throwing.generate_back(5, identity), std::length_error);
+  EXPECT_TRUE(throwing.empty());
+
+  jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::grow> growing(4);
+  growing.generate_back(3, identity);
+  growing.pop_front();
+  EXPECT_EQ(growing.generate_back(6, identity), 6u);
+  EXPECT_EQ(std::vector<int>(growing.begin(), growing.end()), (std::vector<int>{ 1, 2, 0, 1, 2, 3, 4, 5 }));
+}
+
+template<class Buffer, class Make>
+void check_insert_erase_against_deque(Buffer& buffer, std::size_t capacity, Make make)
+{
+  typedef typename Buffer::value_type value_type;
+  std::deque<value_type>              expected;
+  std::mt19937                        random(42);
+  for (int i = 0; i < 2000; ++i) {
+    const std::size_t k = expected.empty() ? 0 : random() % (expected.size() + 1);
+    const unsigned    op = random() % 4;
+    if (op == 0 && k < expected.size()) {
+      const std::size_t m = random() % (expected.size() - k + 1);
+      const auto        it = buffer.erase(std::next(buffer.cbegin(), static_cast<std::ptrdiff_t>(k)),
+                                   std::next(buffer.cbegin(), static_cast<std::ptrdiff_t>(k + m)));
+      expected.erase(expected.begin() + static_cast<std::ptrdiff_t>(k),
+                     expected.begin() + static_cast<std::ptrdiff_t>(k + m));
+      EXPECT_EQ(std::distance(buffer.begin(), it), static_cast<std::ptrdiff_t>(k));
+    }
+    else if (op == 1 && k < expected.size()) {
+      buffer.erase(std::next(buffer.cbegin(), static_cast<std::ptrdiff_t>(k)));
+      expected.erase(expected.begin() + static_cast<std::ptrdiff_t>(k));
+    }
+    else if (expected.size() < capacity) {
+      const value_type value = make(i);
+      const auto       it = buffer.insert(std::next(buffer.cbegin(), static_cast<std::ptrdiff_t>(k)), value);
+      expected.insert(expected.begin() + static_cast<std::ptrdiff_t>(k), value);
+      EXPECT_EQ(*it, value);
+    }
+    else
+      buffer.pop_front(), expected.pop_front();
+
+    ASSERT_EQ(std::vector<value_type>(buffer.begin(), buffer.end()),
+              std::vector<value_type>(expected.begin(), expected.end()));
+  }
+}
+
+TEST(insert_erase, matches_std_deque_anywhere_in_the_ring)
+{
+  jm::static_circular_buffer<int, 13> ints;
+  check_insert_erase_against_deque(ints, 13, [](int i) { return i; });
+
+  jm::static_circular_buffer<std::string, 9> strings;
+  check_insert_erase_against_deque(strings, 9, [](int i) { return std::string(20, 'a') + std::to_string(i); });
+
+  jm::dynamic_circular_buffer<int> dynamic_ints(11);
+  check_insert_erase_against_deque(dynamic_ints, 11, [](int i) { return i; });
+
+  jm::dynamic_circular_buffer<std::string> dynamic_strings(8);
+  check_insert_erase_against_deque(dynamic_strings, 8, [](int i) { return std::to_string(i); });
+}
+
+TEST(insert_erase, full_buffer_follows_the_overflow_policy)
+{
+  jm::static_circular_buffer<int, 4> overwriting{ 0, 1, 2, 3 };
+  auto it = overwriting.insert(std::next(overwriting.cbegin(), 2), 9); // evicts 0
+  EXPECT_EQ(*it, 9);
+  EXPECT_EQ(std::vector<int>(overwriting.begin(), overwriting.end()), (std::vector<int>{ 1, 9, 2, 3 }));
+  it = overwriting.insert(overwriting.cbegin(), 8); // would be the oldest
+  EXPECT_EQ(std::vector<int>(overwriting.begin(), overwriting.end()), (std::vector<int>{ 1, 9, 2, 3 }));
+
+  jm::dynamic_circular_buffer<int, std::allocator<int>, jm::overflow::reject> rejecting(2);
+  rejecting.push_back(0);
+  rejecting.push_back(1);
+  EXPECT_TRUE(rejecting.insert(rejecting.cbegin(), 5) == rejecting.end());
+  jm::static_circular_buffer<int, 2, jm::overflow::throw_exception> throwing{ 6, 7 };
+  EXPECT_THROW(throwing.emplace(throwing.cend(), 1), std::length_error);
+  EXPECT_EQ(throwing.back(), 7);
+
+  jm::dynamic_circular_buffer<std::string, std::allocator<std::string>, jm::overflow::grow> growing(2);
+  growing.push_back("a");
+  growing.push_back("c");
+  growing.insert(std::next(growing.cbegin()), growing.front()); // refers to an element
+  growing.insert(std::next(growing.cbegin(), 2), "b");
+  EXPECT_EQ(std::vector<std::string>(growing.begin(), growing.end()), (std::vector<std::string>{ "a", "a", "b", "c" }));
+}
+
+TEST(consume, visits_both_segments_in_place_then_pops_them)
+{
+  jm::static_circular_buffer<std::string, 5> buffer;
+  for (int i = 0; i < 8; ++i) // wraps, 3 .. 7 are left
+    buffer.push_back(std::to_string(i));
+
+  std::vector<std::string> seen;
+  EXPECT_EQ(buffer.consume([&](std::string& s) { seen.push_back(std::move(s)); }, 3), 3u);
+  EXPECT_EQ(seen, (std::vector<std::string>{ "3", "4", "5" }));
+  EXPECT_EQ(buffer.size(), 2u);
+  EXPECT_EQ(buffer.front(), "6");
+
+  // elements before the throwing call are popped
+  buffer.push_back("8");
+  EXPECT_THROW(buffer.consume([](const std::string& s) {
+                 if (s == "7")
+                   throw std::runtime_error("bad element");
+               }),
+               std::runtime_error);
+  EXPECT_EQ(std::vector<std::string>(buffer.begin(), buffer.end()), (std::vector<std::string>{ "7", "8" }));
+
+  jm::dynamic_circular_buffer<int> ints(4);
+  for (int i = 0; i < 6; ++i)
+    ints.push_back(i);
+  std::vector<std::size_t> segments;
+  int                      sum = 0;
+  EXPECT_EQ(ints.consume_segments([&](const int* data, std::size_t n) {
+              segments.push_back(n);
+              sum = std::accumulate(data, data + n, sum);
+            }),
+            4u);
+  EXPECT_EQ(segments, (std::vector<std::size_t>{ 1, 3 }));
+  EXPECT_EQ(sum, 2 + 3 + 4 + 5);
+  EXPECT_TRUE(ints.empty());
+  EXPECT_EQ(ints.consume([](int) {}), 0u);
+}
+
+TEST(consume, try_consume_frees_a_batch_of_records)
+{
+  jm::spsc_byte_record_ring ring(4096);
+  constexpr std::uint32_t  count = 100000;
+
+  std::thread producer([&] {
+    char message[sizeof(std::uint32_t) + 100] = {};
+    for (std::uint32_t i = 0; i < count; ++i) {
+      std::memcpy(message, &i, sizeof(i));
+      while (!ring.write(message, sizeof(i) + i % 100))
+        std::this_thread::yield();
+    }
+  });
+
+  std::uint32_t next = 0;
+  bool          ok = true;
+  while (next < count && ok)
+    if (ring.try_consume(
+          [&](jm::spsc_byte_record_ring::record record) {
+            std::uint32_t value;
+            std::memcpy(&value, record.data, sizeof(value));
+            ok = ok && value == next && record.size == sizeof(value) + next % 100;
+            ++next;
+          },
+          64) == 0)
+      std::this_thread::yield();
+  producer.join();
+
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(next, count);
+  EXPECT_TRUE(ring.empty());
+  EXPECT_EQ(ring.try_consume([](jm::spsc_byte_record_ring::record) {}), 0u);
+}
+
+#ifdef JM_CIRCULAR_BUFFER_CXX20
+// counts the live objects, so a constant evaluation proves every element got destroyed
+struct constexpr_tracked {
+  int* live;
+  int  value;
+
+  constexpr constexpr_tracked(int* live_, int value_) : live(live_), value(value_) { ++*live; }
+
+  constexpr constexpr_tracked(const constexpr_tracked& other) : live(other.live), value(other.value) { ++*live; }
+
+  constexpr constexpr_tracked& operator=(const constexpr_tracked&) = default;
+
+  constexpr ~constexpr_tracked() { --*live; }
+};
+
+constexpr int constexpr_tracked_ring()
+{
+  int live = 0;
+  {
+    jm::static_circular_buffer<constexpr_tracked, 4> ring;
+    for (int i = 0; i < 6; ++i)
+      ring.emplace_back(&live, i); // 2 3 4 5
+    ring.pop_front();
+    ring.push_front(constexpr_tracked(&live, 9));          // 9 3 4 5
+    ring.erase(std::next(ring.cbegin()));                   // 9 4 5
+    ring.emplace(std::next(ring.cbegin(), 2), &live, 7);    // 9 4 7 5
+
+    jm::static_circular_buffer<constexpr_tracked, 4> copy(ring);
+    copy.consume([](constexpr_tracked&) {}, 1);             // 4 7 5
+    int digits = 0;
+    for (const constexpr_tracked& element : copy)
+      digits = digits * 10 + element.value;
+    if (digits != 475 || live != 7)
+      return -1;
+
+    std::size_t consumed = 0;
+    copy.consume_segments([&consumed](constexpr_tracked*, std::size_t n) { consumed += n; });
+    if (consumed != 3 || !copy.empty() || live != 4)
+      return -1;
+  }
+  return live;
+}
+static_assert(constexpr_tracked_ring() == 0);
+
+constexpr jm::static_circular_buffer<int, 8> make_squares()
+{
+  jm::static_circular_buffer<int, 8> squares;
+  squares.generate_back(10, [](std::size_t i) { return static_cast<int>(i * i); }); // 4 .. 81
+  squares.erase(squares.cbegin(), std::next(squares.cbegin(), 2));                 // 16 .. 81
+  squares.insert(std::next(squares.cbegin(), 3), -1);
+  squares.recycle_back() = 100;
+  squares.recycle_back() = 121; // evicts 16
+  return squares;
+}
+static_assert(make_squares().front() == 25);
+static_assert(make_squares().back() == 121);
+static_assert(make_squares().size() == 8);
+
+constinit jm::static_circular_buffer<int, 8> constant_initialized_squares = make_squares();
+
+TEST(constexpr_buffer, constant_initialized_table)
+{
+  EXPECT_EQ(std::vector<int>(constant_initialized_squares.begin(), constant_initialized_squares.end()),
+            (std::vector<int>{ 25, 36, -1, 49, 64, 81, 100, 121 }));
+}
+#endif
+
+// pushed into by an initializer that runs before the rings' definitions, which only
+// survives if the rings are constant initialized
+extern jm::static_circular_buffer<int, 4>         early_ints;
+extern jm::static_circular_buffer<std::string, 4> early_strings;
+const bool early_pushes = (early_ints.push_back(7), early_strings.push_back("early"), true);
+jm::static_circular_buffer<int, 4>         early_ints;
+jm::static_circular_buffer<std::string, 4> early_strings;
+
+TEST(construction, namespace_scope_buffer_is_constant_initialized)
+{
+  ASSERT_TRUE(early_pushes);
+  ASSERT_EQ(early_ints.size(), 1u);
+  EXPECT_EQ(early_ints.front(), 7);
+  ASSERT_EQ(early_strings.size(), 1u);
+  EXPECT_EQ(early_strings.front(), "early");
+}
+
+#ifdef JM_CB_TEST_LINUX
+TEST(construction, default_constructor_touches_no_slot_page)
+{
+  typedef jm::static_circular_buffer<char, (64 << 20)> buffer;
+  const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  void*             memory = mmap(nullptr, sizeof(buffer), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  ASSERT_NE(memory, MAP_FAILED);
+  madvise(memory, sizeof(buffer), MADV_NOHUGEPAGE);
+
+  buffer*                    ring = new (memory) buffer;
+  std::vector<unsigned char> resident((sizeof(buffer) + page - 1) / page);
+  ASSERT_EQ(mincore(memory, sizeof(buffer), resident.data()), 0);
+  // at most the page holding head, tail and size
+  EXPECT_LE(std::count_if(resident.begin(), resident.end(), [](unsigned char r) { return (r & 1) != 0; }), 1);
+
+  ring->push_back('x');
+  EXPECT_EQ(ring->front(), 'x');
+  ring->~buffer();
+  munmap(memory, sizeof(buffer));
+}
+#endif